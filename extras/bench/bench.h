@@ -0,0 +1,74 @@
+#ifndef _bench_h
+#define _bench_h
+
+/**
+ * Helpers shared by the host tests and benchmarks.
+ *
+ * `CHECK()` counts a failure (and says where) instead of stopping, so a program reports
+ * everything that went wrong; `main()` ends with `return benchResult();`.
+ */
+
+#include <ESP32RotaryEncoder.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+static int benchFailures = 0;
+
+#define CHECK( condition ) \
+  do { if( !( condition ) ) { fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition ); benchFailures++; } } while( 0 )
+
+#define CHECK_EQUAL( actual, expected ) \
+  do { long long _a = ( actual ), _e = ( expected ); if( _a != _e ) { fprintf( stderr, "%s:%d: check failed: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, _a, _e ); benchFailures++; } } while( 0 )
+
+static inline int benchResult()
+{
+  if( benchFailures > 0 )
+    fprintf( stderr, "%d check(s) failed\n", benchFailures );
+
+  return ( benchFailures > 0 ) ? 1 : 0;
+}
+
+/**
+ * Real (not simulated) nanoseconds that `body` takes, best of `runs` so that a hiccup
+ * of the host doesn't count.
+ */
+template<typename Body>
+static double elapsedNs( Body body, int runs = 3 )
+{
+  double best = 0;
+
+  for( int i = 0; i < runs; i++ )
+  {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+
+    if( i == 0 || ns < best )
+      best = ns;
+  }
+
+  return best;
+}
+
+// Two pins nothing is ever attached to, to time the simulator on its own
+#define BENCH_IDLE_PIN_A 60
+#define BENCH_IDLE_PIN_B 61
+
+/**
+ * Real nanoseconds per edge spent in whatever ISRs are attached to `pinA` and `pinB`.
+ *
+ * The same waveform is played into two pins with nothing attached, and that time (the
+ * simulator's own) is taken off, which leaves the ISRs plus the GPIO dispatch around them.
+ */
+static inline double isrNsPerEdge( uint8_t pinA, uint8_t pinB, long steps = 200000 )
+{
+  double withISR = elapsedNs( [=]{ RotaryEncoderHost::turn( pinA, pinB, steps, 1 ); } );
+  double without = elapsedNs( [=]{ RotaryEncoderHost::turn( BENCH_IDLE_PIN_A, BENCH_IDLE_PIN_B, steps, 1 ); } );
+
+  return ( withISR > without ) ? ( withISR - without ) / steps : 0;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * What the ISR and PCNT backends cost while the knob sits still and while it turns:
+ * interrupts, timer callbacks and task wake-ups per simulated second, and the real time
+ * this host spends getting through that second.
+ *
+ * The PCNT backend must take no interrupts at all, and both must end on the same value.
+ * The host's pulse counter is emulated in software on every edge, so its real time says
+ * little about the board, where the peripheral counts for free; the counts are the point.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define DETENTS 100
+
+typedef struct {
+  uint32_t interrupts;
+  uint32_t timers;
+  uint32_t wakes;
+  double ns;
+} BackendLoad;
+
+// Runs one simulated second, turning `detents` detents spread evenly across it
+static BackendLoad oneSecond( RotaryEncoder &encoder, long detents )
+{
+  uint32_t interrupts = RotaryEncoderHost::interruptCount();
+  uint32_t timers = RotaryEncoderHost::timerCount();
+  uint32_t wakes = RotaryEncoderHost::taskWakeCount();
+
+  double ns = elapsedNs( [&]{
+    if( detents == 0 )
+      RotaryEncoderHost::advance( 1000000 );
+
+    else
+      RotaryEncoderHost::turn( PIN_A, PIN_B, detents * RE_DEFAULT_STEPS, 1000000 / ( detents * RE_DEFAULT_STEPS ) );
+
+    encoder.encoderChanged();
+  }, 1 );
+
+  return {
+    RotaryEncoderHost::interruptCount() - interrupts,
+    RotaryEncoderHost::timerCount() - timers,
+    RotaryEncoderHost::taskWakeCount() - wakes,
+    ns
+  };
+}
+
+static long run( EncoderBackend backend, const char *name )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -1000000, 1000000 );
+  encoder.begin( true, backend );
+
+  BackendLoad idle = oneSecond( encoder, 0 );
+  BackendLoad busy = oneSecond( encoder, DETENTS );
+
+  printf( "  %-5s idle %10u %8u %8u %10.0f\n", name, idle.interrupts, idle.timers, idle.wakes, idle.ns / 1000 );
+  printf( "  %-5s busy %10u %8u %8u %10.0f\n", name, busy.interrupts, busy.timers, busy.wakes, busy.ns / 1000 );
+
+  if( backend == PCNT_BACKEND )
+  {
+    CHECK_EQUAL( idle.interrupts, 0 );
+    CHECK_EQUAL( busy.interrupts, 0 );
+  }
+  else
+  {
+    CHECK_EQUAL( idle.interrupts, 0 );
+    CHECK_EQUAL( busy.interrupts, DETENTS * RE_DEFAULT_STEPS );
+  }
+
+  return encoder.getEncoderValue();
+}
+
+int main()
+{
+  printf( "Per simulated second, %d detents when busy:\n", DETENTS );
+  printf( "  backend    %10s %8s %8s %10s\n", "interrupts", "timers", "wakes", "host us" );
+
+  long isr = run( ISR_BACKEND, "ISR" );
+  long pcnt = run( PCNT_BACKEND, "PCNT" );
+
+  CHECK_EQUAL( isr, DETENTS );
+  CHECK_EQUAL( pcnt, isr );
+
+  return benchResult();
+}
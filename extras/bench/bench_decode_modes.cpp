@@ -0,0 +1,58 @@
+/**
+ * Interrupts per detent and CPU per revolution of `_encoder_ISR()` in each decode mode,
+ * for encoders of 4 and 2 steps per detent, turning a knob of `DETENTS_PER_REV` detents.
+ *
+ * Each mode must count every detent, with 4, 2 or 1 interrupts per cycle of A and B;
+ * X1 on a 2-step encoder can't see single detents, so it must be refused and X4 kept.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define DETENTS_PER_REV 24
+#define REVOLUTIONS 100
+
+static void measure( uint8_t steps, DecodeMode mode, uint32_t expectedInterrupts, const char *note = "" )
+{
+  long detents = DETENTS_PER_REV * REVOLUTIONS;
+  long edges = detents * steps;
+
+  RotaryEncoderHost::reset();
+
+  double without = elapsedNs( [=]{ RotaryEncoderHost::turn( BENCH_IDLE_PIN_A, BENCH_IDLE_PIN_B, edges, 500 ); }, 1 );
+
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B, -1, -1, steps );
+  encoder.setBoundaries( -1000000, 1000000 );
+  encoder.setDecodeMode( mode );
+  encoder.begin( false );
+
+  double with = elapsedNs( [=]{ RotaryEncoderHost::turn( PIN_A, PIN_B, edges, 500 ); }, 1 );
+
+  double interruptsPerDetent = (double)RotaryEncoderHost::interruptCount() / detents;
+  double nsPerRevolution = ( with > without ) ? ( with - without ) / REVOLUTIONS : 0;
+
+  printf( "  %5u     X%u %8ld %14.2f %10.0f %s\n", steps, mode, encoder.getEncoderValue(), interruptsPerDetent, nsPerRevolution, note );
+
+  CHECK_EQUAL( encoder.getEncoderValue(), detents );
+  CHECK_EQUAL( RotaryEncoderHost::interruptCount(), expectedInterrupts * detents );
+}
+
+int main()
+{
+  printf( "%d revolutions of %d detents:\n", REVOLUTIONS, DETENTS_PER_REV );
+  printf( "  steps   mode  counted  irq per detent  ns per rev\n" );
+
+  measure( 4, DECODE_X4, 4 );
+  measure( 4, DECODE_X2, 2 );
+  measure( 4, DECODE_X1, 1 );
+
+  measure( 2, DECODE_X4, 2 );
+  measure( 2, DECODE_X2, 1 );
+  measure( 2, DECODE_X1, 2, "(refused; decoded in X4)" );
+
+  return benchResult();
+}
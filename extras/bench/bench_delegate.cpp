@@ -0,0 +1,115 @@
+/**
+ * Callbacks must not touch the heap: setting them, turning the knob and dispatching
+ * to them has to make no allocations at all, which is counted by replacing the global
+ * `operator new`.  Also measured:
+ *
+ * - Real nanoseconds per call of a `RotaryEncoderDelegate`, next to a `std::function`
+ *   holding the same lambda (which a small lambda doesn't make allocate either; the
+ *   difference is that the delegate can't be handed one that does).
+ * - Simulated microseconds from the edge that completes a detent to the `onTurned()`
+ *   callback, with `DISPATCH_TIMER` and `DISPATCH_NOTIFY`.  The host runs a notified
+ *   task in the same simulated microsecond; on the board, add a context switch.
+ */
+
+#include "bench.h"
+
+#include <functional>
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define DETENTS 50
+#define CALLS 10000000
+
+static unsigned long allocations = 0;
+
+void *operator new( size_t size )
+{
+  allocations++;
+
+  void *p = malloc( size ? size : 1 );
+  if( p == NULL )
+    throw std::bad_alloc();
+
+  return p;
+}
+
+void operator delete( void *p ) noexcept
+{
+  free( p );
+}
+
+void operator delete( void *p, size_t ) noexcept
+{
+  free( p );
+}
+
+// Average simulated microseconds from the last edge of a detent to its callback
+static double dispatchLatency( DispatchMode mode, unsigned long &allocated )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -1000, 1000 );
+  encoder.setDispatchMode( mode );
+  encoder.begin();
+
+  RotaryEncoderHost::advance( 1000 );
+
+  unsigned long start = allocations;
+
+  uint64_t calledAt = 0;
+  long calls = 0;
+  encoder.onTurned( [&calledAt, &calls]( long ){ calledAt = RotaryEncoderHost::now(); calls++; } );
+  encoder.onPressed( [&calls]( unsigned long ){ calls--; } );
+
+  uint64_t total = 0;
+
+  for( int i = 0; i < DETENTS; i++ )
+  {
+    // A prime number of microseconds between detents, so they land all over the loop period
+    RotaryEncoderHost::advance( 7919 );
+
+    calledAt = 0;
+    RotaryEncoderHost::turn( PIN_A, PIN_B, RE_DEFAULT_STEPS, 100 );
+
+    uint64_t edgeAt = RotaryEncoderHost::now();
+
+    RotaryEncoderHost::advance( 2 * RE_LOOP_INTERVAL );
+
+    CHECK( calledAt >= edgeAt );
+    total += calledAt - edgeAt;
+  }
+
+  allocated = allocations - start;
+
+  CHECK_EQUAL( calls, DETENTS );
+
+  return (double)total / DETENTS;
+}
+
+int main()
+{
+  long sum = 0;
+  auto lambda = [&sum]( long value ){ sum += value; };
+
+  RotaryEncoderDelegate<void(long)> delegate( lambda );
+  std::function<void(long)> function( lambda );
+
+  double delegateNs = elapsedNs( [&]{ for( long i = 0; i < CALLS; i++ ) delegate( i ); } ) / CALLS;
+  double functionNs = elapsedNs( [&]{ for( long i = 0; i < CALLS; i++ ) function( i ); } ) / CALLS;
+
+  unsigned long timerAllocations, notifyAllocations;
+
+  double timerUs = dispatchLatency( DISPATCH_TIMER, timerAllocations );
+  double notifyUs = dispatchLatency( DISPATCH_NOTIFY, notifyAllocations );
+
+  printf( "Call:     RotaryEncoderDelegate %.2f ns, std::function %.2f ns (checksum %ld)\n", delegateNs, functionNs, sum );
+  printf( "Dispatch: DISPATCH_TIMER  %6.0f us, %lu allocations\n", timerUs, timerAllocations );
+  printf( "          DISPATCH_NOTIFY %6.0f us, %lu allocations\n", notifyUs, notifyAllocations );
+
+  CHECK_EQUAL( timerAllocations, 0 );
+  CHECK_EQUAL( notifyAllocations, 0 );
+
+  return benchResult();
+}
@@ -0,0 +1,125 @@
+/**
+ * `DISPATCH_TIMER` against `DISPATCH_NOTIFY`, with a few coalescing windows: how long
+ * after the detent `onTurned()` fires (in simulated time), how many calls a fast spin
+ * makes, and how often the chip has to wake up while nobody touches the knob.
+ *
+ * The timer can be up to `RE_LOOP_INTERVAL` late and wakes every interval whether or not
+ * anything happened; the dispatcher task must call back within its coalescing window
+ * (right away without one) and not wake at all while idle.  Every detent must be counted.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define DETENTS 50
+#define GAP_US 137000     // Between single detents; not a multiple of the loop interval
+#define STEP_US 1000      // A step per millisecond within a detent
+#define SPIN 40           // Detents in one fast spin
+#define IDLE_US 10000000  // 10 s of nobody touching it
+
+typedef struct {
+  const char *name;
+  DispatchMode mode;
+  uint32_t coalesceMs;
+} Dispatch;
+
+static const Dispatch dispatches[] = {
+  { "timer",               DISPATCH_TIMER,   0 },
+  { "notify",              DISPATCH_NOTIFY,  0 },
+  { "notify, 5 ms window", DISPATCH_NOTIFY,  5 },
+  { "notify, 20 ms window", DISPATCH_NOTIFY, 20 }
+};
+
+static void measure( const Dispatch &dispatch )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -100000, 100000 );
+  encoder.setDispatchMode( dispatch.mode );
+  encoder.setCoalesceWindow( dispatch.coalesceMs );
+
+  uint64_t calledAt = 0;
+  int calls = 0;
+  long reported = 0;
+
+  encoder.onTurned( [&]( long value ){ calledAt = RotaryEncoderHost::now(); calls++; reported = value; } );
+  encoder.begin();
+
+  // Single detents, each given time to be reported before the next
+  uint64_t totalLatency = 0, maxLatency = 0;
+  int late = 0;
+
+  for( int i = 0; i < DETENTS; i++ )
+  {
+    calledAt = 0;
+
+    RotaryEncoderHost::turn( PIN_A, PIN_B, RE_DEFAULT_STEPS, STEP_US );
+    uint64_t detentAt = RotaryEncoderHost::now();
+
+    RotaryEncoderHost::advance( GAP_US - RE_DEFAULT_STEPS * STEP_US );
+
+    if( calledAt < detentAt )
+    {
+      late++;
+      continue;
+    }
+
+    uint64_t latency = calledAt - detentAt;
+
+    totalLatency += latency;
+    if( latency > maxLatency )
+      maxLatency = latency;
+  }
+
+  CHECK_EQUAL( late, 0 );
+  CHECK_EQUAL( reported, DETENTS );
+
+  // One fast spin: a detent every 4 ms
+  int callsBefore = calls;
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, SPIN * RE_DEFAULT_STEPS, STEP_US );
+  RotaryEncoderHost::advance( RE_LOOP_INTERVAL + dispatch.coalesceMs * 1000 );
+
+  int spinCalls = calls - callsBefore;
+
+  CHECK_EQUAL( reported, DETENTS + SPIN );
+
+  // Nobody touching it
+  uint32_t wakeups = RotaryEncoderHost::wakeupCount();
+  RotaryEncoderHost::advance( IDLE_US );
+  wakeups = RotaryEncoderHost::wakeupCount() - wakeups;
+
+  printf( "  %-22s %8.1f %8.1f %10d %14u\n", dispatch.name, totalLatency / 1000.0 / DETENTS, maxLatency / 1000.0, spinCalls, wakeups );
+
+  if( dispatch.mode == DISPATCH_TIMER )
+  {
+    CHECK( maxLatency <= RE_LOOP_INTERVAL );
+    CHECK_EQUAL( wakeups, IDLE_US / RE_LOOP_INTERVAL );
+  }
+  else
+  {
+    CHECK( maxLatency <= dispatch.coalesceMs * 1000 );
+    CHECK_EQUAL( wakeups, 0 );
+
+    // Without a window, every detent of the spin is its own call; with one, they're merged
+    if( dispatch.coalesceMs == 0 )
+      CHECK_EQUAL( spinCalls, SPIN );
+    else
+      CHECK( spinCalls < SPIN );
+  }
+}
+
+int main()
+{
+  printf( "%d single detents %u ms apart, a spin of %d detents at %u ms each, then %u s idle:\n",
+    DETENTS, GAP_US / 1000, SPIN, RE_DEFAULT_STEPS * STEP_US / 1000, IDLE_US / 1000000 );
+  printf( "  %-22s %8s %8s %10s %14s\n", "dispatch", "avg ms", "max ms", "spin calls", "idle wakeups" );
+
+  for( const Dispatch &dispatch : dispatches )
+    measure( dispatch );
+
+  return benchResult();
+}
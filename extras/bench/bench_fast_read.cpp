@@ -0,0 +1,47 @@
+/**
+ * Per-edge cost of `_encoder_ISR()` reading A and B with two `digitalRead()` calls, and
+ * with `setFastRead()` picking both out of one GPIO input register read.
+ *
+ * On the host, `digitalRead()` is an array lookup and `REG_READ()` assembles a whole
+ * register from the simulated pins, so the host numbers favour `digitalRead()`; what
+ * they do show is the rest of the ISR, and that both ways decode the same.  On the
+ * board, `digitalRead()` goes through the Arduino HAL twice per edge.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+static double measure( bool fastRead, long &value )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -1000000, 1000000 );
+  encoder.setFastRead( fastRead );
+  encoder.begin( false );
+
+  // Three runs of 200000 steps right each, for the best of three
+  double ns = isrNsPerEdge( PIN_A, PIN_B );
+
+  value = encoder.getEncoderValue();
+
+  return ns;
+}
+
+int main()
+{
+  long slowValue, fastValue;
+
+  double slow = measure( false, slowValue );
+  double fast = measure( true, fastValue );
+
+  printf( "digitalRead(): %6.1f ns per edge\n", slow );
+  printf( "fast read:     %6.1f ns per edge\n", fast );
+
+  CHECK_EQUAL( slowValue, 3 * 200000 / RE_DEFAULT_STEPS );
+  CHECK_EQUAL( fastValue, slowValue );
+
+  return benchResult();
+}
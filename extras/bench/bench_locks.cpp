@@ -0,0 +1,81 @@
+/**
+ * How long `mux` is held, and by whom, while the knob turns and the application polls.
+ *
+ * The readers (`getEncoderValue()`, `encoderChanged()`, `buttonPressed()`, `getPosition()`)
+ * read atomic snapshots, so polling them in a tight loop must not take the lock at all;
+ * whatever is left outside the ISRs comes from `loop()` and the setters.  Times are real
+ * nanoseconds on this host, from `RotaryEncoderHost::lockHold()`.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+#define PIN_BUTTON 23
+
+#define DETENTS 1000
+#define POLLS 100
+
+static void print( const char *who, HostLockHold hold )
+{
+  printf( "  %-28s %8u %10.1f %8u\n", who, hold.count, hold.count ? (double)hold.totalNs / hold.count : 0, hold.maxNs );
+}
+
+static long pollReaders( RotaryEncoder &encoder )
+{
+  return encoder.getEncoderValue() + encoder.encoderChanged() + encoder.buttonPressed() + (long)encoder.getPosition().count;
+}
+
+int main()
+{
+  long polled = 0;
+  HostLockHold isr, rest, readers;
+
+  {
+    RotaryEncoderHost::reset();
+
+    RotaryEncoder encoder( PIN_A, PIN_B, PIN_BUTTON );
+    encoder.setBoundaries( -1000000, 1000000 );
+    encoder.begin();
+
+    // Turn the knob, polling every reader a few times after every step
+    for( long step = 0; step < DETENTS * RE_DEFAULT_STEPS; step++ )
+    {
+      RotaryEncoderHost::turn( PIN_A, PIN_B, 1, 250 );
+
+      for( int poll = 0; poll < POLLS; poll++ )
+        polled += pollReaders( encoder );
+    }
+
+    isr = RotaryEncoderHost::lockHold( true );
+    rest = RotaryEncoderHost::lockHold( false );
+  }
+
+  {
+    // The readers on their own, with nothing else running
+    RotaryEncoderHost::reset();
+
+    RotaryEncoder encoder( PIN_A, PIN_B, PIN_BUTTON );
+    encoder.begin( false );
+
+    HostLockHold before = RotaryEncoderHost::lockHold( false );
+
+    for( int poll = 0; poll < DETENTS * POLLS; poll++ )
+      polled += pollReaders( encoder );
+
+    readers = RotaryEncoderHost::lockHold( false );
+    readers.count -= before.count;
+    readers.totalNs -= before.totalNs;
+  }
+
+  printf( "Critical sections over %d detents, each reader polled %d times per step (checksum %ld):\n", DETENTS, POLLS, polled );
+  printf( "  %-28s %8s %10s %8s\n", "held by", "count", "mean ns", "max ns" );
+  print( "ISRs", isr );
+  print( "loop(), timers and readers", rest );
+  print( "readers alone", readers );
+
+  CHECK_EQUAL( isr.count, DETENTS * RE_DEFAULT_STEPS );
+  CHECK_EQUAL( readers.count, 0 );
+
+  return benchResult();
+}
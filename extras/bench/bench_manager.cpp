@@ -0,0 +1,79 @@
+/**
+ * Timer callbacks and wake-ups per idle second for 1 to 8 encoders, each with its own
+ * loop timer and all serviced by `RotaryEncoderManager`.
+ *
+ * Individually, both grow with the number of encoders; managed, they must stay where
+ * they are for one encoder, however many are added.
+ */
+
+#include "bench.h"
+#include <RotaryEncoderManager.h>
+
+#define MAX_KNOBS 8
+
+typedef struct {
+  uint32_t timers;
+  uint32_t wakeups;
+} IdleLoad;
+
+static IdleLoad idleSecond( int knobs, bool managed )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder *encoders[MAX_KNOBS];
+
+  for( int i = 0; i < knobs; i++ )
+  {
+    encoders[i] = new RotaryEncoder( 4 + i * 3, 5 + i * 3, 6 + i * 3 );
+    encoders[i]->begin( !managed );
+
+    if( managed )
+      RotaryEncoderManager::add( *encoders[i] );
+  }
+
+  if( managed )
+    RotaryEncoderManager::begin();
+
+  // Let everything start up before counting
+  RotaryEncoderHost::advance( 1000 );
+
+  uint32_t timers = RotaryEncoderHost::timerCount();
+  uint32_t wakeups = RotaryEncoderHost::wakeupCount();
+
+  RotaryEncoderHost::advance( 1000000 );
+
+  IdleLoad load = { RotaryEncoderHost::timerCount() - timers, RotaryEncoderHost::wakeupCount() - wakeups };
+
+  if( managed )
+    RotaryEncoderManager::end();
+
+  for( int i = 0; i < knobs; i++ )
+    delete encoders[i];
+
+  return load;
+}
+
+int main()
+{
+  IdleLoad first = {};
+
+  printf( "Per idle second:\n" );
+  printf( "  encoders   timers (individual, managed)   wakeups (individual, managed)\n" );
+
+  for( int knobs = 1; knobs <= MAX_KNOBS; knobs++ )
+  {
+    IdleLoad individual = idleSecond( knobs, false );
+    IdleLoad managed = idleSecond( knobs, true );
+
+    printf( "  %8i   %18u %8u   %19u %8u\n", knobs, individual.timers, managed.timers, individual.wakeups, managed.wakeups );
+
+    if( knobs == 1 )
+      first = managed;
+
+    CHECK_EQUAL( managed.timers, first.timers );
+    CHECK_EQUAL( managed.wakeups, first.wakeups );
+    CHECK( individual.timers >= managed.timers * knobs );
+  }
+
+  return benchResult();
+}
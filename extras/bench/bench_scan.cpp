@@ -0,0 +1,178 @@
+/**
+ * What `RotaryEncoderManager::scan()` costs as the number of `SCAN_BACKEND` encoders
+ * grows: real nanoseconds per scan when nothing moved, and per edge decoded when every
+ * encoder moved, or just one.  Nothing moved should cost about the same however many
+ * encoders there are, and so should each edge; only the walk over the encoders that
+ * didn't move grows with the count.
+ *
+ * Every encoder must end up with exactly the detents it was turned.  Then one encoder,
+ * sampled by the `beginScan()` timer, is turned faster than the scan interval: every
+ * step must be counted while a step fits in the interval, and once two steps do, the
+ * decoder must see the invalid transitions (and, with `setGlitchFilter()`, recover them).
+ * Three steps between samples look just like one step back, which no decoder can tell
+ * apart; that row is there to show it.
+ */
+
+#include "bench.h"
+#include <RotaryEncoderManager.h>
+
+#define SCANS 200000
+#define DETENTS 500
+
+// Pins 2 and 3 for the first encoder, and so on; the last few are in the second GPIO bank
+#define PIN_A( i ) ( 2 + 2 * ( i ) )
+#define PIN_B( i ) ( 3 + 2 * ( i ) )
+
+// Steps a pair of pins along the Gray code sequence, by hand, so that a scan can follow each step
+static void step( uint8_t pinA, uint8_t pinB, uint8_t &index, int direction )
+{
+  static const uint8_t sequence[4] = { 0b11, 0b01, 0b00, 0b10 };
+
+  index = ( index + ( ( direction > 0 ) ? 1 : 3 ) ) & 0x03;
+
+  RotaryEncoderHost::setPin( pinA, ( sequence[index] >> 1 ) & 0x01 );
+  RotaryEncoderHost::setPin( pinB, sequence[index] & 0x01 );
+}
+
+// Every other encoder turns left
+static int direction( int i )
+{
+  return ( i % 2 ) ? -1 : 1;
+}
+
+static void measure( int count )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder *encoders[RE_MAX_ENCODERS];
+  uint8_t index[RE_MAX_ENCODERS] = {};
+
+  for( int i = 0; i < count; i++ )
+  {
+    encoders[i] = new RotaryEncoder( PIN_A( i ), PIN_B( i ) );
+    encoders[i]->setBoundaries( -100000, 100000 );
+    encoders[i]->begin( false, SCAN_BACKEND );
+    RotaryEncoderManager::add( *encoders[i] );
+  }
+
+  double idle = elapsedNs( []{
+    for( int i = 0; i < SCANS; i++ )
+      RotaryEncoderManager::scan();
+  } ) / SCANS;
+
+  // All of them take a step before each scan; the pin writes alone are timed and taken off
+  const int steps = DETENTS * RE_DEFAULT_STEPS;
+
+  uint8_t spare[RE_MAX_ENCODERS] = {};
+  double writes = elapsedNs( [&]{
+    for( int s = 0; s < steps; s++ )
+      for( int i = 0; i < count; i++ )
+        step( BENCH_IDLE_PIN_A, BENCH_IDLE_PIN_B, spare[i], direction( i ) );
+  }, 1 );
+
+  double all = elapsedNs( [&]{
+    for( int s = 0; s < steps; s++ )
+    {
+      for( int i = 0; i < count; i++ )
+        step( PIN_A( i ), PIN_B( i ), index[i], direction( i ) );
+
+      RotaryEncoderManager::scan();
+    }
+  }, 1 );
+
+  // Just the last one, back to where it was
+  double one = elapsedNs( [&]{
+    for( int s = 0; s < steps; s++ )
+    {
+      step( PIN_A( count - 1 ), PIN_B( count - 1 ), index[count - 1], -direction( count - 1 ) );
+      RotaryEncoderManager::scan();
+    }
+  }, 1 );
+
+  double allPerEdge = ( all - writes ) / ( (double)steps * count );
+  double onePerEdge = ( one - writes / count ) / steps;
+
+  printf( "  %8d %12.1f %14.1f %14.1f\n", count, idle, allPerEdge, onePerEdge );
+
+  for( int i = 0; i < count; i++ )
+  {
+    long expected = ( i == count - 1 ) ? 0 : direction( i ) * DETENTS;
+
+    CHECK_EQUAL( encoders[i]->getEncoderValue(), expected );
+    CHECK_EQUAL( encoders[i]->getInvalidTransitions(), 0 );
+  }
+
+  for( int i = 0; i < count; i++ )
+  {
+    RotaryEncoderManager::remove( *encoders[i] );
+    delete encoders[i];
+  }
+}
+
+// One encoder on the scan timer, turned one detent at a time with `stepInterval` between steps
+static void missed( uint32_t stepInterval, bool filter )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A( 0 ), PIN_B( 0 ) );
+  encoder.setBoundaries( -100000, 100000 );
+
+  if( filter )
+    encoder.setGlitchFilter( 1 );
+
+  encoder.begin( false, SCAN_BACKEND );
+
+  RotaryEncoderManager::add( encoder );
+  RotaryEncoderManager::beginScan( RE_SCAN_INTERVAL );
+
+  RotaryEncoderHost::turn( PIN_A( 0 ), PIN_B( 0 ), DETENTS * RE_DEFAULT_STEPS, stepInterval );
+  RotaryEncoderHost::advance( RE_SCAN_INTERVAL );
+
+  long value = encoder.getEncoderValue();
+  uint32_t invalid = encoder.getInvalidTransitions();
+
+  printf( "  %6lu us %-8s %8ld %10lu\n", (unsigned long)stepInterval, filter ? "filter" : "none", value, (unsigned long)invalid );
+
+  // A step every interval or slower: every step is sampled
+  if( stepInterval >= RE_SCAN_INTERVAL )
+  {
+    CHECK_EQUAL( value, DETENTS );
+    CHECK_EQUAL( invalid, 0 );
+  }
+
+  // Up to two steps per interval: some samples skip one, and the decoder notices
+  else if( 2 * stepInterval >= RE_SCAN_INTERVAL )
+  {
+    CHECK( invalid > 0 );
+
+    if( filter )
+      CHECK_EQUAL( value, DETENTS );
+    else
+      CHECK( value < DETENTS );
+  }
+
+  RotaryEncoderManager::end();
+  RotaryEncoderManager::remove( encoder );
+}
+
+int main()
+{
+  printf( "Real ns on this host, %d scans idle and %d steps per encoder turning:\n", SCANS, DETENTS * RE_DEFAULT_STEPS );
+  printf( "  %8s %12s %14s %14s\n", "encoders", "idle / scan", "all / edge", "one / edge" );
+
+  for( int count = 1; count <= 16 && count <= RE_MAX_ENCODERS; count *= 2 )
+    measure( count );
+
+  printf( "\n%d detents, scanned every %u us:\n", DETENTS, RE_SCAN_INTERVAL );
+  printf( "  %9s %-8s %8s %10s\n", "step", "recovery", "detents", "invalid" );
+
+  const uint32_t intervals[] = { 1000, 500, 400, 300, 250, 150 };
+
+  for( uint32_t interval : intervals )
+  {
+    missed( interval, false );
+    missed( interval, true );
+  }
+
+  return benchResult();
+}
@@ -0,0 +1,136 @@
+/**
+ * `_encoder_ISR()` of `RotaryEncoderT` against that of `RotaryEncoder`, per edge, and
+ * the size of each object; both must count the same detents.  The template reads the
+ * pins with `REG_READ()`, which the host builds up from every simulated pin, so here it
+ * can come out slower than it is on the board (see bench_fast_read).
+ *
+ * What this can't show is the IRAM each ISR takes on the board, which is most of the
+ * reason to use the template: the host has no IRAM.  For that, build a sketch with
+ * one or the other and compare the `.iram0.text` section of the two ELF files, e.g.
+ * with `xtensa-esp32-elf-size -A`.
+ *
+ * The template's own boundaries are checked as well: clamped and circular, with steps
+ * that overshoot the range, out to the full range of `long`.
+ */
+
+#include "bench.h"
+#include <RotaryEncoderT.h>
+
+#include <limits.h>
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define STEPS 200000
+
+// Where `detents` of `step` from `value` should land, worked out modulo the range
+static long expected( long value, long step, long detents, long minValue, long maxValue, bool circular )
+{
+  unsigned long span = (unsigned long)maxValue - (unsigned long)minValue;
+
+  for( long i = 0; i < ( detents < 0 ? -detents : detents ); i++ )
+  {
+    __int128 next = (__int128)value + ( detents < 0 ? -(__int128)step : (__int128)step );
+
+    if( next >= minValue && next <= maxValue )
+      value = (long)next;
+    else if( !circular )
+      value = ( next < minValue ) ? minValue : maxValue;
+    else
+    {
+      __int128 range = (__int128)span + 1;
+      __int128 offset = ( next - minValue ) % range;
+
+      value = (long)( minValue + ( offset < 0 ? offset + range : offset ) );
+    }
+  }
+
+  return value;
+}
+
+// Turns a template encoder by `detents` from `start`, and checks where it ends up
+template<bool Circular>
+static void checkBoundaries( long minValue, long maxValue, long step, long start, long detents )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoderT<PIN_A, PIN_B, RE_DEFAULT_STEPS, Circular> bounded;
+  bounded.setBoundaries( minValue, maxValue );
+  bounded.setStepValue( step );
+  bounded.setEncoderValue( start );
+  bounded.begin();
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, detents * RE_DEFAULT_STEPS, 1000 );
+
+  long value = bounded.getEncoderValue();
+  bounded.end();
+
+  CHECK_EQUAL( value, expected( start, step, detents, minValue, maxValue, Circular ) );
+}
+
+int main()
+{
+  double classNs;
+  long classValue;
+
+  {
+    RotaryEncoderHost::reset();
+
+    RotaryEncoder encoder( PIN_A, PIN_B );
+    encoder.setBoundaries( -1000000, 1000000 );
+    encoder.setAcceleration( ACCEL_NONE );
+    encoder.begin( false );
+
+    classNs = isrNsPerEdge( PIN_A, PIN_B, STEPS );
+    classValue = encoder.getEncoderValue();
+  }
+
+  RotaryEncoderHost::reset();
+
+  RotaryEncoderT<PIN_A, PIN_B> lean;
+  lean.setBoundaries( -1000000, 1000000 );
+  lean.begin();
+
+  double templateNs = isrNsPerEdge( PIN_A, PIN_B, STEPS );
+  long templateValue = lean.getEncoderValue();
+
+  lean.end();
+
+  printf( "                  ns per edge   object bytes\n" );
+  printf( "RotaryEncoder     %11.1f   %12u\n", classNs, (unsigned int)sizeof( RotaryEncoder ) );
+  printf( "RotaryEncoderT    %11.1f   %12u (plus its static state)\n", templateNs, (unsigned int)sizeof( RotaryEncoderT<PIN_A, PIN_B> ) );
+  printf( "IRAM taken by each ISR can't be measured on the host.\n" );
+
+  CHECK_EQUAL( classValue, 3 * STEPS / RE_DEFAULT_STEPS );
+  CHECK_EQUAL( templateValue, classValue );
+
+  // Clamped and circular, past each end, by a step at a time and by more than the range
+  const long steps[] = { 1, 5, 100, -5 };
+
+  for( long step : steps )
+  {
+    for( long detents : { 3, -3, 20, -20 } )
+    {
+      checkBoundaries<false>( -3, 3, step, 2, detents );
+      checkBoundaries<true>( -3, 3, step, 2, detents );
+      checkBoundaries<true>( 0, 0, step, 0, detents );
+    }
+  }
+
+  // The full range of long, which doesn't fit a signed difference
+  const long huge[] = { 1, LONG_MAX, LONG_MIN + 1, LONG_MAX / 3 };
+
+  for( long step : huge )
+  {
+    for( long detents : { 1, -1, 3, -3 } )
+    {
+      checkBoundaries<false>( LONG_MIN, LONG_MAX, step, LONG_MAX - 1, detents );
+      checkBoundaries<false>( LONG_MIN, LONG_MAX, step, LONG_MIN + 1, detents );
+      checkBoundaries<true>( LONG_MIN, LONG_MAX, step, LONG_MAX - 1, detents );
+      checkBoundaries<true>( LONG_MIN, LONG_MAX, step, LONG_MIN + 1, detents );
+      checkBoundaries<true>( LONG_MIN + 1, LONG_MAX, step, 0, detents );
+    }
+  }
+
+  return benchResult();
+}
@@ -0,0 +1,91 @@
+/**
+ * How fast `_encoder_ISR()` is, and how fast the knob can spin before detents go missing.
+ *
+ *   bench_throughput [-l latency_us] [-n detents] [step_us ...]
+ *
+ * - ISR nanoseconds per edge, measured on this host, and the edge rate that would keep
+ *   this host's CPU fully busy.
+ * - Detents counted at each step interval (default 1000 down to 1 us), with every ISR
+ *   modelled as taking `latency_us` (default 5, a rough figure for a CHANGE interrupt
+ *   on an ESP32; measure your board and pass it in).  The same spin with no latency
+ *   must lose nothing, which is what makes this a test as well.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+// Turns `detents` detents right, one step every `stepUs`, and returns how many were counted
+static long countedDetents( long detents, uint32_t stepUs, uint32_t latencyUs )
+{
+  RotaryEncoderHost::reset();
+  RotaryEncoderHost::setInterruptLatency( latencyUs );
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -1000000, 1000000 );
+  encoder.begin( false );
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, detents * RE_DEFAULT_STEPS, stepUs );
+  RotaryEncoderHost::advance( 1000 );
+
+  return encoder.getEncoderValue();
+}
+
+int main( int argc, char **argv )
+{
+  uint32_t latency = 5;
+  long detents = 200;
+  uint32_t intervals[32] = { 1000, 250, 100, 50, 20, 10, 5, 2, 1 };
+  size_t intervalCount = 9;
+  bool defaultIntervals = true;
+
+  for( int i = 1; i < argc; i++ )
+  {
+    if( !strcmp( argv[i], "-l" ) && i + 1 < argc )
+      latency = atol( argv[++i] );
+
+    else if( !strcmp( argv[i], "-n" ) && i + 1 < argc )
+      detents = atol( argv[++i] );
+
+    else
+    {
+      // The first interval given replaces the defaults
+      if( defaultIntervals )
+      {
+        intervalCount = 0;
+        defaultIntervals = false;
+      }
+
+      if( intervalCount < 32 )
+        intervals[intervalCount++] = atol( argv[i] );
+    }
+  }
+
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -1000000, 1000000 );
+  encoder.begin( false );
+
+  double ns = isrNsPerEdge( PIN_A, PIN_B );
+
+  printf( "ISR: %.1f ns per edge on this host, %.1f M edges/s sustained\n\n", ns, ( ns > 0 ) ? 1000.0 / ns : 0 );
+
+  printf( "Detents counted out of %ld, ISR modelled at %u us (merged edges can even count backwards):\n", detents, latency );
+  printf( "  step (us)   edges/s   ideal   modelled   missed\n" );
+
+  for( size_t i = 0; i < intervalCount; i++ )
+  {
+    uint32_t step = intervals[i] ? intervals[i] : 1;
+
+    long ideal = countedDetents( detents, step, 0 );
+    long modelled = countedDetents( detents, step, latency );
+
+    printf( "  %9u %9lu %7ld %10ld %8ld\n", step, 1000000UL / step, ideal, modelled, detents - modelled );
+
+    CHECK_EQUAL( ideal, detents );
+  }
+
+  return benchResult();
+}
@@ -0,0 +1,163 @@
+/**
+ * `startCapture()` and `stopCapture()` round trip: what an encoder captures while it is
+ * turned and clicked, played back into a fresh one with `RotaryEncoderHost::replay()`,
+ * must end on the same value, position and presses.
+ *
+ * When the ring is too small, `stopCapture()` must return its size, with the newest
+ * entries oldest first: the same as the end of a capture of the same turn that had room,
+ * in time order.  Played back from a detent, that is the value the last of the turn added.
+ */
+
+#include "bench.h"
+
+#include <algorithm>
+#include <vector>
+
+#define PIN_A 21
+#define PIN_B 22
+#define PIN_BUTTON 23
+
+#define STEP_US 2000
+#define TIME_MASK ( 0xFFFFFFFFUL >> RE_CAPTURE_TIME_SHIFT )
+
+typedef struct {
+  long value;
+  int64_t position;
+  long presses;
+} Outcome;
+
+static long presses;
+
+static RotaryEncoder *start()
+{
+  RotaryEncoderHost::reset();
+  presses = 0;
+
+  RotaryEncoder *encoder = new RotaryEncoder( PIN_A, PIN_B, PIN_BUTTON );
+  encoder->setBoundaries( -1000, 1000 );
+  encoder->onPressed( []( unsigned long ){ presses++; } );
+  encoder->begin();
+
+  RotaryEncoderHost::advance( 100000 );
+
+  return encoder;
+}
+
+static Outcome finish( RotaryEncoder *encoder )
+{
+  RotaryEncoderHost::advance( 300000 );
+
+  Outcome outcome = { encoder->getEncoderValue(), encoder->getPosition().count, presses };
+  delete encoder;
+
+  return outcome;
+}
+
+// A bouncy turn with a click in the middle, captured into `buffer`
+static Outcome capture( std::vector<uint32_t> &buffer, long right, long left )
+{
+  RotaryEncoder *encoder = start();
+
+  RotaryEncoderHost::setBounce( 2, 30 );
+
+  encoder->startCapture( buffer.data(), buffer.size() );
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, right * RE_DEFAULT_STEPS, STEP_US );
+  RotaryEncoderHost::advance( 50000 );
+  RotaryEncoderHost::setButton( PIN_BUTTON, true );
+  RotaryEncoderHost::advance( 100000 );
+  RotaryEncoderHost::setButton( PIN_BUTTON, false );
+  RotaryEncoderHost::advance( 100000 );
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -left * RE_DEFAULT_STEPS, STEP_US );
+
+  buffer.resize( encoder->stopCapture() );
+
+  return finish( encoder );
+}
+
+static Outcome replay( const std::vector<uint32_t> &entries )
+{
+  RotaryEncoder *encoder = start();
+
+  RotaryEncoderHost::replay( entries.data(), entries.size(), PIN_A, PIN_B, PIN_BUTTON );
+
+  return finish( encoder );
+}
+
+// Every entry after the one before, and by no more than `maxGap` microseconds
+static void checkOrder( const std::vector<uint32_t> &entries, uint32_t maxGap )
+{
+  for( size_t i = 1; i < entries.size(); i++ )
+  {
+    uint32_t gap = ( ( entries[i] >> RE_CAPTURE_TIME_SHIFT ) - ( entries[i - 1] >> RE_CAPTURE_TIME_SHIFT ) ) & TIME_MASK;
+
+    CHECK( gap <= maxGap );
+  }
+}
+
+// A clean turn of `detents` right, captured into a ring of `size`
+static std::vector<uint32_t> captureTurn( long detents, size_t size )
+{
+  std::vector<uint32_t> buffer( size );
+  RotaryEncoder *encoder = start();
+
+  encoder->startCapture( buffer.data(), buffer.size() );
+  RotaryEncoderHost::turn( PIN_A, PIN_B, detents * RE_DEFAULT_STEPS, STEP_US );
+  buffer.resize( encoder->stopCapture() );
+
+  finish( encoder );
+
+  return buffer;
+}
+
+int main()
+{
+  // Plenty of room
+  std::vector<uint32_t> buffer( 4096 );
+  Outcome original = capture( buffer, 9, 4 );
+  Outcome replayed = replay( buffer );
+
+  printf( "turn and click, %4u entries: value %ld/%ld, position %lld/%lld, presses %ld/%ld (captured/replayed)\n",
+    (unsigned int)buffer.size(), original.value, replayed.value, (long long)original.position, (long long)replayed.position,
+    original.presses, replayed.presses );
+
+  CHECK( buffer.size() > 1 && buffer.size() < 4096 );
+  checkOrder( buffer, 300000 );
+
+  CHECK_EQUAL( original.value, 9 - 4 );
+  CHECK_EQUAL( original.presses, 1 );
+  CHECK_EQUAL( replayed.value, original.value );
+  CHECK_EQUAL( replayed.position, original.position );
+  CHECK_EQUAL( replayed.presses, original.presses );
+
+  // Rings that go around: one with room for the lot to compare against, then smaller ones
+  const long detents = 50;
+  std::vector<uint32_t> full = captureTurn( detents, 4096 );
+
+  // The pins at the start, and then an entry per step
+  CHECK_EQUAL( full.size(), 1 + detents * RE_DEFAULT_STEPS );
+
+  const size_t sizes[] = { 1, 50, 1 + 16 * RE_DEFAULT_STEPS, full.size() - 1 };
+
+  for( size_t size : sizes )
+  {
+    std::vector<uint32_t> ring = captureTurn( detents, size );
+
+    CHECK_EQUAL( ring.size(), size );
+    checkOrder( ring, STEP_US );
+
+    // The newest, oldest first
+    CHECK( std::equal( ring.begin(), ring.end(), full.end() - ring.size() ) );
+
+    // Played back from the pins it starts on, which are at a detent when a whole number
+    // of detents is left: the value of just those
+    Outcome outcome = replay( ring );
+
+    printf( "ring of %4u: %4u entries, replayed value %ld\n", (unsigned int)size, (unsigned int)ring.size(), outcome.value );
+
+    if( ( ring.size() - 1 ) % RE_DEFAULT_STEPS == 0 )
+      CHECK_EQUAL( outcome.value, (long)( ( ring.size() - 1 ) / RE_DEFAULT_STEPS ) );
+  }
+
+  return benchResult();
+}
@@ -0,0 +1,140 @@
+/**
+ * Property tests of the boundaries: under random boundaries, step values, turns and
+ * speeds, a clamped value must stop at the boundaries and a circular one must wrap
+ * exactly as arithmetic modulo the range says, however far a step overshoots.  With
+ * acceleration on, the multipliers depend on timing, so only the range is checked.
+ *
+ * Boundaries stay within 32 bits, as `long` is on the board; the full range of a
+ * 64-bit `long` (the host's) is tried separately.
+ */
+
+#include "bench.h"
+
+#include <limits.h>
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define TRIALS 200
+#define TURNS 50
+
+static uint32_t seed = 12345;
+
+// A deterministic pseudo-random number, so a failure can be reproduced
+static uint32_t nextRandom()
+{
+  seed = seed * 1103515245UL + 12345UL;
+
+  return seed >> 1;
+}
+
+static int64_t randomBetween( int64_t low, int64_t high )
+{
+  uint64_t r = ( (uint64_t)nextRandom() << 31 ) | nextRandom();
+
+  return low + (int64_t)( r % (uint64_t)( high - low + 1 ) );
+}
+
+// What the value should be, worked out the long way
+static int64_t expected( int64_t value, int64_t minValue, int64_t maxValue, bool circular )
+{
+  if( value >= minValue && value <= maxValue )
+    return value;
+
+  if( !circular )
+    return ( value < minValue ) ? minValue : maxValue;
+
+  int64_t range = maxValue - minValue + 1;
+  int64_t offset = ( value - minValue ) % range;
+
+  return minValue + ( ( offset < 0 ) ? offset + range : offset );
+}
+
+static void trial( int number, bool accelerated )
+{
+  RotaryEncoderHost::reset();
+
+  // Narrow, wide and single-value ranges, anywhere within 32 bits
+  int64_t width;
+  switch( nextRandom() % 4 )
+  {
+    case 0:  width = 0; break;
+    case 1:  width = randomBetween( 1, 10 ); break;
+    case 2:  width = randomBetween( 11, 100000 ); break;
+    default: width = randomBetween( 100001, INT32_MAX ); break;
+  }
+
+  int64_t minValue = randomBetween( INT32_MIN, INT32_MAX - width );
+  int64_t maxValue = minValue + width;
+  bool circular = nextRandom() % 2;
+
+  // Steps from 1 to several times the range, so some overshoot it
+  long stepValue = (long)randomBetween( 1, ( width < INT32_MAX / 3 ) ? 3 * width + 1 : INT32_MAX );
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setStepValue( stepValue );
+  encoder.setAcceleration( accelerated ? ACCEL_LINEAR : ACCEL_NONE, 10 );
+  encoder.setBoundaries( (long)minValue, (long)maxValue, circular );
+  encoder.begin( false );
+
+  encoder.setEncoderValue( (long)randomBetween( minValue, maxValue ) );
+  int64_t value = encoder.getEncoderValue();
+
+  for( int turn = 0; turn < TURNS; turn++ )
+  {
+    long detents = (long)randomBetween( -5, 5 );
+    uint32_t stepUs = (uint32_t)randomBetween( 100, 20000 );  // From a fast spin to a slow click
+
+    RotaryEncoderHost::turn( PIN_A, PIN_B, detents * RE_DEFAULT_STEPS, stepUs );
+
+    long actual = encoder.getEncoderValue();
+
+    if( actual < minValue || actual > maxValue )
+    {
+      fprintf( stderr, "trial %d, turn %d: %ld outside %lld...%lld\n", number, turn, actual, (long long)minValue, (long long)maxValue );
+      benchFailures++;
+      return;
+    }
+
+    if( accelerated )
+      continue;
+
+    for( long i = 0; i < labs( detents ); i++ )
+      value = expected( value + ( ( detents > 0 ) ? stepValue : -stepValue ), minValue, maxValue, circular );
+
+    if( actual != value )
+    {
+      fprintf( stderr, "trial %d, turn %d: %ld, expected %lld (%lld...%lld%s, step %ld)\n", number, turn, actual, (long long)value,
+        (long long)minValue, (long long)maxValue, circular ? ", circular" : "", stepValue );
+      benchFailures++;
+      return;
+    }
+  }
+}
+
+int main()
+{
+  for( int i = 0; i < TRIALS; i++ )
+  {
+    trial( i, false );
+    trial( i, true );
+  }
+
+  // The full range of long, whose span doesn't fit a signed difference
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( LONG_MIN, LONG_MAX, true );
+  encoder.begin( false );
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -3 * RE_DEFAULT_STEPS, 1000 );
+  CHECK_EQUAL( encoder.getEncoderValue(), -3 );
+
+  encoder.setEncoderValue( LONG_MAX );
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -1 * RE_DEFAULT_STEPS, 1000 );
+  CHECK_EQUAL( encoder.getEncoderValue(), LONG_MAX - 1 );
+
+  printf( "%d trials of %d turns each, clamped and circular, with and without acceleration\n", TRIALS, TURNS );
+
+  return benchResult();
+}
@@ -0,0 +1,127 @@
+/**
+ * Missed and double presses of each de-bounce mode over recorded-style contact bounce:
+ * every press and release of a click is followed by a burst of bounce with random gaps,
+ * and the clicks come at random (and sometimes quick) intervals.
+ *
+ * As long as the gaps in the bounce are shorter than the debounce time and the button
+ * stays put for longer than it, `DEBOUNCE_INTEGRATING` must count every click exactly
+ * once, however long the bounce goes on.  `DEBOUNCE_LOCKOUT` must too while the whole
+ * burst fits in the debounce time; past that, the rates show what it lets through.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+#define PIN_BUTTON 23
+
+#define CLICKS 500
+#define DEBOUNCE_US 30000
+
+typedef struct {
+  const char *name;
+  uint8_t maxBounces;     // Up to this many extra back-and-forth flips per change
+  uint32_t maxGap;        // Microseconds between flips, up to
+  uint32_t minHold;       // Shortest time the button is held down or left up, in microseconds
+} BounceProfile;
+
+static const BounceProfile profiles[] = {
+  { "clean",                     0,     0, 40000 },
+  { "short bounce",              4,  2000, 40000 },
+  { "long bounce, short gaps",  12,  5000, 40000 },
+  { "sparse bounce",             3, 12000, 60000 }
+};
+
+static uint32_t seed = 1;
+
+static uint32_t nextRandom( uint32_t limit )
+{
+  seed = seed * 1103515245UL + 12345UL;
+
+  return ( limit > 0 ) ? ( seed >> 1 ) % limit : 0;
+}
+
+// Drives the button to `pressed`, bouncing on the way; returns how long the bounce lasted
+static uint32_t bounce( const BounceProfile &profile, bool pressed )
+{
+  uint32_t lasted = 0;
+  uint8_t flips = nextRandom( profile.maxBounces + 1 );
+
+  RotaryEncoderHost::setPin( PIN_BUTTON, pressed ? LOW : HIGH );
+
+  for( uint8_t i = 0; i < flips; i++ )
+  {
+    for( bool back : { true, false } )
+    {
+      uint32_t gap = 50 + nextRandom( profile.maxGap );
+
+      RotaryEncoderHost::advance( gap );
+      RotaryEncoderHost::setPin( PIN_BUTTON, ( pressed != back ) ? LOW : HIGH );
+      lasted += gap;
+    }
+  }
+
+  return lasted;
+}
+
+static void run( const BounceProfile &profile, DebounceMode mode )
+{
+  RotaryEncoderHost::reset();
+  seed = 1;
+
+  RotaryEncoder encoder( PIN_A, PIN_B, PIN_BUTTON );
+  encoder.setButtonDebounce( DEBOUNCE_US, mode );
+
+  long presses = 0;
+  encoder.onPressed( [&presses]( unsigned long ){ presses++; } );
+  encoder.begin();
+
+  long missed = 0, doubled = 0;
+  uint32_t longest = 0;
+
+  for( int click = 0; click < CLICKS; click++ )
+  {
+    long before = presses;
+
+    for( bool pressed : { true, false } )
+    {
+      uint32_t lasted = bounce( profile, pressed );
+
+      if( lasted > longest )
+        longest = lasted;
+
+      RotaryEncoderHost::advance( profile.minHold + nextRandom( 100000 ) );
+    }
+
+    // Let loop() catch up before the next click
+    RotaryEncoderHost::advance( 2 * RE_LOOP_INTERVAL );
+
+    if( presses == before )
+      missed++;
+    else
+      doubled += presses - before - 1;
+  }
+
+  printf( "  %-25s %-12s %6lu %7.1f%% %7.1f%%\n", profile.name, ( mode == DEBOUNCE_LOCKOUT ) ? "lockout" : "integrating",
+    (unsigned long)longest, 100.0 * missed / CLICKS, 100.0 * doubled / CLICKS );
+
+  if( mode == DEBOUNCE_INTEGRATING || longest < DEBOUNCE_US )
+  {
+    CHECK_EQUAL( missed, 0 );
+    CHECK_EQUAL( doubled, 0 );
+  }
+}
+
+int main()
+{
+  printf( "%d clicks, %d us debounce:\n", CLICKS, DEBOUNCE_US );
+  printf( "  %-25s %-12s %6s %8s %8s\n", "bounce", "mode", "max us", "missed", "double" );
+
+  for( const BounceProfile &profile : profiles )
+  {
+    run( profile, DEBOUNCE_LOCKOUT );
+    run( profile, DEBOUNCE_INTEGRATING );
+  }
+
+  return benchResult();
+}
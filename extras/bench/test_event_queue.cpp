@@ -0,0 +1,178 @@
+/**
+ * The event queue must hand back every detent and button edge in the order they
+ * happened, each stamped with the time of the edge that made it, with the step applied
+ * to the value, or how long the button was held; count what's dropped once the ring is
+ * full (keeping the oldest); and deliver exactly the same through `onEvent()` as through
+ * `drainEvents()`.
+ */
+
+#include "bench.h"
+
+#include <vector>
+
+#define STEP_US 1000
+
+// One knob and button, stepped by hand so the time of every edge is known
+struct Knob {
+  uint8_t pinA, pinB, pinButton;
+  uint8_t index;
+
+  void step( int direction )
+  {
+    static const uint8_t sequence[4] = { 0b11, 0b01, 0b00, 0b10 };
+
+    index = ( index + ( ( direction > 0 ) ? 1 : 3 ) ) & 0x03;
+
+    RotaryEncoderHost::setPin( pinA, ( sequence[index] >> 1 ) & 0x01 );
+    RotaryEncoderHost::setPin( pinB, sequence[index] & 0x01 );
+  }
+};
+
+static Knob knobs[2] = { { 21, 22, 23, 0 }, { 25, 26, 27, 0 } };
+
+// Both knobs at once, a step every STEP_US; returns the time the detent was completed
+static uint32_t detent( int direction )
+{
+  for( int i = 0; i < RE_DEFAULT_STEPS; i++ )
+  {
+    RotaryEncoderHost::advance( STEP_US );
+
+    for( Knob &knob : knobs )
+      knob.step( direction );
+  }
+
+  return (uint32_t)RotaryEncoderHost::now();
+}
+
+static uint32_t button( bool pressed )
+{
+  for( Knob &knob : knobs )
+    RotaryEncoderHost::setButton( knob.pinButton, pressed );
+
+  return (uint32_t)RotaryEncoderHost::now();
+}
+
+static void checkEvent( const EncoderEvent &event, EncoderEventType type, long value, uint32_t timestamp )
+{
+  CHECK_EQUAL( event.type, type );
+  CHECK_EQUAL( event.value, value );
+  CHECK_EQUAL( event.timestamp, timestamp );
+}
+
+int main()
+{
+  RotaryEncoderHost::reset();
+
+  // Drained by hand, with no loop() running to take the events first
+  RotaryEncoder drained( knobs[0].pinA, knobs[0].pinB, knobs[0].pinButton );
+  drained.setBoundaries( -1000, 1000 );
+  drained.setEventQueue();
+  drained.begin( false );
+
+  // ...and the same, handed to `onEvent()` by the loop timer
+  std::vector<EncoderEvent> delivered;
+
+  RotaryEncoder handled( knobs[1].pinA, knobs[1].pinB, knobs[1].pinButton );
+  handled.setBoundaries( -1000, 1000 );
+  handled.setEventQueue();
+  handled.onEvent( [&delivered]( const EncoderEvent &event ){ delivered.push_back( event ); } );
+  handled.begin();
+
+  RotaryEncoderHost::advance( 100000 );
+
+  // Two right, a 150 ms click, one left
+  uint32_t right1 = detent( 1 );
+  uint32_t right2 = detent( 1 );
+
+  RotaryEncoderHost::advance( 50000 );
+  uint32_t pressed = button( true );
+
+  RotaryEncoderHost::advance( 150000 );
+  uint32_t released = button( false );
+
+  RotaryEncoderHost::advance( 50000 );
+  uint32_t left = detent( -1 );
+
+  RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+  // Two at a time, to see the order kept across calls
+  std::vector<EncoderEvent> events;
+  EncoderEvent batch[2];
+  size_t count;
+
+  while( ( count = drained.drainEvents( batch, 2 ) ) > 0 )
+    events.insert( events.end(), batch, batch + count );
+
+  printf( "Drained %u events, delivered %u:\n", (unsigned int)events.size(), (unsigned int)delivered.size() );
+  for( const EncoderEvent &event : events )
+    printf( "  type %u, value %ld, at %lu us\n", event.type, event.value, (unsigned long)event.timestamp );
+
+  CHECK_EQUAL( events.size(), 5 );
+
+  if( events.size() == 5 )
+  {
+    checkEvent( events[0], TURNED_RIGHT, 1, right1 );
+    checkEvent( events[1], TURNED_RIGHT, 1, right2 );
+    checkEvent( events[2], BUTTON_PRESSED, 0, pressed );
+    checkEvent( events[3], BUTTON_RELEASED, 150, released );
+    checkEvent( events[4], TURNED_LEFT, -1, left );
+  }
+
+  // `onEvent()` saw exactly the same
+  CHECK_EQUAL( delivered.size(), events.size() );
+
+  for( size_t i = 0; i < delivered.size() && i < events.size(); i++ )
+  {
+    CHECK_EQUAL( delivered[i].type, events[i].type );
+    CHECK_EQUAL( delivered[i].value, events[i].value );
+    CHECK_EQUAL( delivered[i].timestamp, events[i].timestamp );
+  }
+
+  CHECK_EQUAL( drained.getEventOverflows(), 0 );
+  CHECK_EQUAL( handled.getEventOverflows(), 0 );
+
+  // More detents than the ring holds, with nothing draining it: the oldest are kept
+  const int extra = 5;
+  uint32_t times[RE_EVENT_QUEUE_SIZE + extra];
+
+  for( int i = 0; i < RE_EVENT_QUEUE_SIZE + extra; i++ )
+    times[i] = detent( 1 );
+
+  RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+  EncoderEvent ring[RE_EVENT_QUEUE_SIZE + extra];
+  count = drained.drainEvents( ring, RE_EVENT_QUEUE_SIZE + extra );
+
+  printf( "%d detents into a ring of %d: %u drained, %lu overflows\n", RE_EVENT_QUEUE_SIZE + extra, RE_EVENT_QUEUE_SIZE, (unsigned int)count, (unsigned long)drained.getEventOverflows() );
+
+  CHECK_EQUAL( count, RE_EVENT_QUEUE_SIZE );
+  CHECK_EQUAL( drained.getEventOverflows(), extra );
+
+  for( size_t i = 0; i < count; i++ )
+    checkEvent( ring[i], TURNED_RIGHT, 1, times[i] );
+
+  // The value counted every detent, dropped events or not
+  CHECK_EQUAL( drained.getEncoderValue(), 2 - 1 + RE_EVENT_QUEUE_SIZE + extra );
+
+  // Drained, the ring takes events again
+  uint32_t after = detent( -1 );
+
+  CHECK_EQUAL( drained.drainEvents( ring, 2 ), 1 );
+  checkEvent( ring[0], TURNED_LEFT, -1, after );
+
+  // The handler kept up, so it dropped nothing
+  RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+  CHECK_EQUAL( handled.getEventOverflows(), 0 );
+  CHECK_EQUAL( delivered.size(), 5 + RE_EVENT_QUEUE_SIZE + extra + 1 );
+
+  // Turning it off and on again discards what's queued and the overflow count
+  detent( 1 );
+  drained.setEventQueue( false );
+  drained.setEventQueue( true );
+
+  CHECK_EQUAL( drained.drainEvents( ring, 2 ), 0 );
+  CHECK_EQUAL( drained.getEventOverflows(), 0 );
+
+  return benchResult();
+}
@@ -0,0 +1,117 @@
+/**
+ * `onButtonGesture()` must tell a click from a double-click by the double-click time,
+ * report a long press once the button has been held for the long-press time and then
+ * repeat at the repeat interval for as long as it stays down, never report a click for
+ * the release after a long press, and leave out whichever gesture `setGestureTiming()`
+ * was given 0 for.
+ */
+
+#include "bench.h"
+
+#include <vector>
+
+#define PIN_A 21
+#define PIN_B 22
+#define PIN_BUTTON 23
+
+#define MS 1000
+
+typedef struct {
+  ButtonGesture gesture;
+  uint64_t at;            // Microseconds since the scenario started
+} Reported;
+
+static std::vector<Reported> reported;
+static uint64_t start;
+
+static const char *gestureName( ButtonGesture gesture )
+{
+  static const char *names[] = { "click", "double-click", "long press", "repeat" };
+  return names[gesture];
+}
+
+// A fresh encoder for each scenario, which then plays out `presses` (down, up) in ms
+static void play( uint32_t longPressMs, uint32_t doubleClickMs, uint32_t repeatMs, std::vector<std::pair<uint32_t, uint32_t>> presses )
+{
+  RotaryEncoderHost::reset();
+  reported.clear();
+
+  RotaryEncoder encoder( PIN_A, PIN_B, PIN_BUTTON );
+  encoder.setGestureTiming( longPressMs, doubleClickMs, repeatMs );
+  encoder.onButtonGesture( []( ButtonGesture gesture ){ reported.push_back( { gesture, RotaryEncoderHost::now() - start } ); } );
+  encoder.begin();
+
+  RotaryEncoderHost::advance( 100 * MS );
+  start = RotaryEncoderHost::now();
+
+  for( auto &press : presses )
+  {
+    RotaryEncoderHost::advance( press.first * MS );
+    RotaryEncoderHost::setButton( PIN_BUTTON, true );
+
+    RotaryEncoderHost::advance( press.second * MS );
+    RotaryEncoderHost::setButton( PIN_BUTTON, false );
+  }
+
+  // Long enough for anything still pending
+  RotaryEncoderHost::advance( 2000 * MS );
+
+  printf( "  long press %4lu, double-click %4lu, repeat %4lu ms:", (unsigned long)longPressMs, (unsigned long)doubleClickMs, (unsigned long)repeatMs );
+  for( const Reported &r : reported )
+    printf( " %s at %llu ms,", gestureName( r.gesture ), (unsigned long long)( r.at / MS ) );
+  printf( "\n" );
+}
+
+static void expect( std::vector<Reported> expected )
+{
+  CHECK_EQUAL( reported.size(), expected.size() );
+
+  for( size_t i = 0; i < reported.size() && i < expected.size(); i++ )
+  {
+    CHECK_EQUAL( reported[i].gesture, expected[i].gesture );
+    CHECK_EQUAL( reported[i].at, expected[i].at * MS );
+  }
+}
+
+int main()
+{
+  printf( "Gestures reported, in ms from the start of each scenario:\n" );
+
+  // A click is only a click once the double-click time has gone by without a second press
+  play( 500, 250, 100, { { 0, 100 } } );
+  expect( { { BUTTON_CLICK, 100 + 250 } } );
+
+  // The second press within it makes a double-click, reported on the second release
+  play( 500, 250, 100, { { 0, 80 }, { 100, 80 } } );
+  expect( { { BUTTON_DOUBLE_CLICK, 80 + 100 + 80 } } );
+
+  // Just outside it: two clicks
+  play( 500, 250, 100, { { 0, 80 }, { 300, 80 } } );
+  expect( { { BUTTON_CLICK, 80 + 250 }, { BUTTON_CLICK, 80 + 300 + 80 + 250 } } );
+
+  // Held for 950 ms: a long press at 500, repeats every 100 after it, and no click on release
+  play( 500, 250, 100, { { 0, 950 } } );
+  expect( { { BUTTON_LONG_PRESS, 500 }, { BUTTON_REPEAT, 600 }, { BUTTON_REPEAT, 700 }, { BUTTON_REPEAT, 800 }, { BUTTON_REPEAT, 900 } } );
+
+  // The same with other timings, to see they're the ones used
+  play( 300, 250, 250, { { 0, 900 } } );
+  expect( { { BUTTON_LONG_PRESS, 300 }, { BUTTON_REPEAT, 550 }, { BUTTON_REPEAT, 800 } } );
+
+  // A long press, then a quick click: the click still waits out the double-click time
+  play( 500, 250, 100, { { 0, 550 }, { 100, 50 } } );
+  expect( { { BUTTON_LONG_PRESS, 500 }, { BUTTON_CLICK, 550 + 100 + 50 + 250 } } );
+
+  // No long presses: holding the button is just a slow click
+  play( 0, 250, 100, { { 0, 950 } } );
+  expect( { { BUTTON_CLICK, 950 + 250 } } );
+
+  // No double-clicks: every click is reported straight away on release
+  play( 500, 0, 100, { { 0, 80 }, { 100, 80 } } );
+  expect( { { BUTTON_CLICK, 80 }, { BUTTON_CLICK, 80 + 100 + 80 } } );
+
+  // No repeats: just the long press
+  play( 500, 250, 0, { { 0, 950 } } );
+  expect( { { BUTTON_LONG_PRESS, 500 } } );
+
+  return benchResult();
+}
@@ -0,0 +1,77 @@
+/**
+ * The latency histogram of `getStats()` must measure up to the moment `onTurned()` is
+ * called, so that a turned policy holding a change back shows up in it; and up to
+ * `encoderChanged()` returning true for an application that polls instead.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define SETTLE_MS 300
+
+// Turns one detent, and returns how long after it `onTurned()` was called
+static uint64_t oneDetent( uint64_t &calledAt )
+{
+  calledAt = 0;
+
+  RotaryEncoderHost::advance( 12345 );
+  RotaryEncoderHost::turn( PIN_A, PIN_B, RE_DEFAULT_STEPS, 1000 );
+
+  uint64_t detentAt = RotaryEncoderHost::now();
+
+  RotaryEncoderHost::advance( 2 * SETTLE_MS * 1000 );
+
+  return ( calledAt >= detentAt ) ? calledAt - detentAt : 0;
+}
+
+int main()
+{
+  uint64_t calledAt = 0;
+
+  // Held back by a settle time, with the callback
+  {
+    RotaryEncoderHost::reset();
+
+    RotaryEncoder encoder( PIN_A, PIN_B );
+    encoder.setBoundaries( -100, 100 );
+    encoder.setTurnedPolicy( 0, 0, SETTLE_MS );
+    encoder.onTurned( [&calledAt]( long ){ calledAt = RotaryEncoderHost::now(); } );
+    encoder.begin();
+
+    uint64_t waited = oneDetent( calledAt );
+    EncoderStats stats = encoder.getStats();
+
+    printf( "Settle %d ms: callback after %llu us, latency recorded %lu...%lu us over %lu reports\n", SETTLE_MS,
+      (unsigned long long)waited, (unsigned long)stats.latency.min, (unsigned long)stats.latency.max, (unsigned long)stats.reports );
+
+    CHECK( waited >= SETTLE_MS * 1000 );
+    CHECK_EQUAL( stats.reports, 1 );
+    CHECK_EQUAL( stats.latency.count, 1 );
+    CHECK_EQUAL( stats.latency.max, waited );
+  }
+
+  // Polled by the application, no callback
+  {
+    RotaryEncoderHost::reset();
+
+    RotaryEncoder encoder( PIN_A, PIN_B );
+    encoder.setBoundaries( -100, 100 );
+    encoder.begin( false );
+
+    RotaryEncoderHost::turn( PIN_A, PIN_B, RE_DEFAULT_STEPS, 1000 );
+    RotaryEncoderHost::advance( 5000 );
+
+    CHECK( encoder.encoderChanged() );
+
+    EncoderStats stats = encoder.getStats();
+
+    printf( "Polled 5 ms later: latency recorded %lu us\n", (unsigned long)stats.latency.max );
+
+    CHECK_EQUAL( stats.reports, 1 );
+    CHECK_EQUAL( stats.latency.max, 5000 );
+  }
+
+  return benchResult();
+}
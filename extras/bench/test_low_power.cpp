@@ -0,0 +1,127 @@
+/**
+ * With `setLowPower()`, an encoder must go idle once nothing has happened for the idle
+ * time, even with a change still held back by a turned policy, as long as no timer
+ * will let that change through: a change short of `minDelta` only another turn can
+ * release, and it must not keep the chip awake forever.  One held back by a rate limit
+ * must still be reported first.
+ *
+ * Waking up must keep the edge that did it, call no GPIO driver or timer function from
+ * the ISR (the driver isn't in IRAM), and get `loop()` running again from a task.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define IDLE_MS 1000
+
+typedef struct {
+  bool idle;
+  uint32_t wakeups;       // In the last of the 10 simulated seconds
+  long reported;
+  int calls;
+} IdleResult;
+
+static IdleResult run( DispatchMode mode, uint32_t minIntervalMs, long minDelta, long detents )
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -100, 100 );
+  encoder.setDispatchMode( mode );
+  encoder.setTurnedPolicy( minIntervalMs, minDelta );
+  encoder.setLowPower( IDLE_MS );
+
+  IdleResult result = {};
+  encoder.onTurned( [&result]( long value ){ result.reported = value; result.calls++; } );
+  encoder.begin();
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, detents * RE_DEFAULT_STEPS, 2000 );
+  RotaryEncoderHost::advance( 9000000 );
+
+  uint32_t wakeups = RotaryEncoderHost::wakeupCount();
+  RotaryEncoderHost::advance( 1000000 );
+
+  result.idle = encoder.isIdle();
+  result.wakeups = RotaryEncoderHost::wakeupCount() - wakeups;
+
+  return result;
+}
+
+int main()
+{
+  for( DispatchMode mode : { DISPATCH_TIMER, DISPATCH_NOTIFY } )
+  {
+    const char *name = ( mode == DISPATCH_TIMER ) ? "timer" : "notify";
+
+    // One detent, short of a minDelta of 5: never reported, and no reason to stay awake
+    IdleResult held = run( mode, 0, 5, 1 );
+
+    printf( "%-6s minDelta 5, 1 detent:    idle %d, %u wakeups in the last second, %d calls\n", name, held.idle, held.wakeups, held.calls );
+
+    CHECK( held.idle );
+    CHECK_EQUAL( held.wakeups, 0 );
+    CHECK_EQUAL( held.calls, 0 );
+
+    // Three quick detents under a 2 s rate limit: the trailing call comes before going idle
+    IdleResult limited = run( mode, 2000, 0, 3 );
+
+    printf( "%-6s 2 s limit, 3 detents:    idle %d, %u wakeups in the last second, %d calls, last value %ld\n", name, limited.idle, limited.wakeups, limited.calls, limited.reported );
+
+    CHECK( limited.idle );
+    CHECK_EQUAL( limited.wakeups, 0 );
+    CHECK_EQUAL( limited.reported, 3 );
+  }
+
+  for( DispatchMode mode : { DISPATCH_TIMER, DISPATCH_NOTIFY } )
+  {
+    const char *name = ( mode == DISPATCH_TIMER ) ? "timer" : "notify";
+
+    RotaryEncoderHost::reset();
+
+    RotaryEncoder encoder( PIN_A, PIN_B );
+    encoder.setBoundaries( -100, 100 );
+    encoder.setDispatchMode( mode );
+    encoder.setLowPower( IDLE_MS );
+
+    long reported = 0;
+    encoder.onTurned( [&reported]( long value ){ reported = value; } );
+    encoder.begin();
+
+    RotaryEncoderHost::advance( 2 * IDLE_MS * 1000 );
+    CHECK( encoder.isIdle() );
+
+    // Two detents from idle: the first edge wakes it, and is decoded like the rest
+    uint32_t wakeups = RotaryEncoderHost::wakeupCount();
+    RotaryEncoderHost::turn( PIN_A, PIN_B, 2 * RE_DEFAULT_STEPS, 2000 );
+    uint32_t turnWakeups = RotaryEncoderHost::wakeupCount() - wakeups;
+
+    RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+    printf( "%-6s woken by 2 detents:     idle %d, %u wakeups while turning, reported %ld, %u driver calls from ISRs\n",
+      name, encoder.isIdle(), turnWakeups, reported, RotaryEncoderHost::isrDriverCallCount() );
+
+    CHECK( !encoder.isIdle() );
+    CHECK_EQUAL( encoder.getEncoderValue(), 2 );
+    CHECK_EQUAL( reported, 2 );
+    CHECK_EQUAL( RotaryEncoderHost::isrDriverCallCount(), 0 );
+
+    // Only the first edge had to wake the chip; the rest are back on their edge interrupts
+    if( mode == DISPATCH_NOTIFY )
+      CHECK_EQUAL( turnWakeups, 1 );
+
+    // ...and it goes idle again, and wakes again
+    RotaryEncoderHost::advance( 2 * IDLE_MS * 1000 );
+    CHECK( encoder.isIdle() );
+
+    RotaryEncoderHost::turn( PIN_A, PIN_B, -RE_DEFAULT_STEPS, 2000 );
+    RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+    CHECK( !encoder.isIdle() );
+    CHECK_EQUAL( reported, 1 );
+    CHECK_EQUAL( RotaryEncoderHost::isrDriverCallCount(), 0 );
+  }
+
+  return benchResult();
+}
@@ -0,0 +1,167 @@
+/**
+ * `RotaryEncoderManager::read()` must report each encoder that was turned or clicked
+ * exactly once, under its id and in priority order, with the value and the delta since
+ * it was last reported; carry whatever didn't fit in `maxChanges` over to the next call;
+ * and bring a PCNT encoder up to date by itself, without anyone calling its getters.
+ */
+
+#include "bench.h"
+#include <RotaryEncoderManager.h>
+
+#define PIN_A1 4
+#define PIN_B1 5
+#define PIN_BUTTON1 6
+#define PIN_A2 7
+#define PIN_B2 8
+#define PIN_BUTTON2 9
+#define PIN_A3 21
+#define PIN_B3 22
+
+static void turn( uint8_t pinA, uint8_t pinB, long detents )
+{
+  RotaryEncoderHost::turn( pinA, pinB, detents * RE_DEFAULT_STEPS, 1000 );
+}
+
+static void click( uint8_t pin )
+{
+  RotaryEncoderHost::setButton( pin, true );
+  RotaryEncoderHost::advance( 100000 );
+  RotaryEncoderHost::setButton( pin, false );
+  RotaryEncoderHost::advance( 100000 );
+}
+
+int main()
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder low( PIN_A1, PIN_B1, PIN_BUTTON1 );
+  RotaryEncoder high( PIN_A2, PIN_B2, PIN_BUTTON2 );
+  RotaryEncoder counted( PIN_A3, PIN_B3 );
+
+  RotaryEncoder *all[] = { &low, &high, &counted };
+
+  for( RotaryEncoder *encoder : all )
+    encoder->setBoundaries( -100, 100 );
+
+  low.begin( false );
+  high.begin( false );
+  counted.begin( false, PCNT_BACKEND );
+
+  RotaryEncoderManager::add( low );
+  RotaryEncoderManager::add( high, 1 );
+  RotaryEncoderManager::add( counted );
+
+  // Ids in the order added, whatever the priority
+  CHECK_EQUAL( RotaryEncoderManager::getId( low ), 0 );
+  CHECK_EQUAL( RotaryEncoderManager::getId( high ), 1 );
+  CHECK_EQUAL( RotaryEncoderManager::getId( counted ), 2 );
+
+  EncoderChange changes[RE_MAX_ENCODERS];
+
+  // Nothing happened yet
+  CHECK_EQUAL( RotaryEncoderManager::read( changes, RE_MAX_ENCODERS ), 0 );
+
+  // All three turned; the higher priority one comes first
+  turn( PIN_A1, PIN_B1, 3 );
+  turn( PIN_A2, PIN_B2, -2 );
+  turn( PIN_A3, PIN_B3, 5 );
+
+  size_t count = RotaryEncoderManager::read( changes, RE_MAX_ENCODERS );
+
+  printf( "All turned: %u changes\n", (unsigned int)count );
+  for( size_t i = 0; i < count; i++ )
+    printf( "  id %u, flags %u, value %ld, delta %ld\n", changes[i].id, changes[i].flags, changes[i].value, changes[i].delta );
+
+  CHECK_EQUAL( count, 3 );
+  CHECK_EQUAL( changes[0].id, 1 );
+  CHECK_EQUAL( changes[0].flags, CHANGED_VALUE );
+  CHECK_EQUAL( changes[0].value, -2 );
+  CHECK_EQUAL( changes[0].delta, -2 );
+  CHECK_EQUAL( changes[1].id, 0 );
+  CHECK_EQUAL( changes[1].flags, CHANGED_VALUE );
+  CHECK_EQUAL( changes[1].value, 3 );
+  CHECK_EQUAL( changes[1].delta, 3 );
+  CHECK_EQUAL( changes[2].id, 2 );
+  CHECK_EQUAL( changes[2].flags, CHANGED_VALUE );
+  CHECK_EQUAL( changes[2].value, 5 );
+  CHECK_EQUAL( changes[2].delta, 5 );
+
+  // Each is reported once
+  CHECK_EQUAL( RotaryEncoderManager::read( changes, RE_MAX_ENCODERS ), 0 );
+
+  // A click on its own is a button change with no delta; with a turn, it's both
+  click( PIN_BUTTON1 );
+
+  count = RotaryEncoderManager::read( changes, RE_MAX_ENCODERS );
+
+  CHECK_EQUAL( count, 1 );
+  CHECK_EQUAL( changes[0].id, 0 );
+  CHECK_EQUAL( changes[0].flags, CHANGED_BUTTON );
+  CHECK_EQUAL( changes[0].value, 3 );
+  CHECK_EQUAL( changes[0].delta, 0 );
+
+  turn( PIN_A2, PIN_B2, 4 );
+  click( PIN_BUTTON2 );
+
+  count = RotaryEncoderManager::read( changes, RE_MAX_ENCODERS );
+
+  CHECK_EQUAL( count, 1 );
+  CHECK_EQUAL( changes[0].id, 1 );
+  CHECK_EQUAL( changes[0].flags, CHANGED_VALUE | CHANGED_BUTTON );
+  CHECK_EQUAL( changes[0].value, 2 );
+  CHECK_EQUAL( changes[0].delta, 4 );
+
+  // A turn there and back still counts as a change, with no delta
+  turn( PIN_A1, PIN_B1, 2 );
+  turn( PIN_A1, PIN_B1, -2 );
+
+  count = RotaryEncoderManager::read( changes, RE_MAX_ENCODERS );
+
+  CHECK_EQUAL( count, 1 );
+  CHECK_EQUAL( changes[0].id, 0 );
+  CHECK_EQUAL( changes[0].flags, CHANGED_VALUE );
+  CHECK_EQUAL( changes[0].delta, 0 );
+
+  // Room for one: the rest wait for the next call, and keep adding up in the meantime
+  turn( PIN_A1, PIN_B1, 1 );
+  turn( PIN_A2, PIN_B2, 1 );
+  turn( PIN_A3, PIN_B3, -1 );
+
+  count = RotaryEncoderManager::read( changes, 1 );
+
+  printf( "Room for one: id %u, delta %ld\n", changes[0].id, changes[0].delta );
+
+  CHECK_EQUAL( count, 1 );
+  CHECK_EQUAL( changes[0].id, 1 );
+  CHECK_EQUAL( changes[0].delta, 1 );
+
+  turn( PIN_A3, PIN_B3, -3 );
+
+  count = RotaryEncoderManager::read( changes, 1 );
+
+  CHECK_EQUAL( count, 1 );
+  CHECK_EQUAL( changes[0].id, 0 );
+  CHECK_EQUAL( changes[0].value, 4 );
+  CHECK_EQUAL( changes[0].delta, 1 );
+
+  count = RotaryEncoderManager::read( changes, 1 );
+
+  printf( "Carried over: id %u, value %ld, delta %ld\n", changes[0].id, changes[0].value, changes[0].delta );
+
+  CHECK_EQUAL( count, 1 );
+  CHECK_EQUAL( changes[0].id, 2 );
+  CHECK_EQUAL( changes[0].value, 1 );
+  CHECK_EQUAL( changes[0].delta, -4 );
+
+  CHECK_EQUAL( RotaryEncoderManager::read( changes, RE_MAX_ENCODERS ), 0 );
+
+  // The getters agree with what was reported
+  CHECK_EQUAL( low.getEncoderValue(), 4 );
+  CHECK_EQUAL( high.getEncoderValue(), 3 );
+  CHECK_EQUAL( counted.getEncoderValue(), 1 );
+
+  for( RotaryEncoder *encoder : all )
+    RotaryEncoderManager::remove( *encoder );
+
+  return benchResult();
+}
@@ -0,0 +1,92 @@
+/**
+ * Several encoders turned at the same time, with their edges interleaved, must each end
+ * up with exactly their own count; and buttons pressed together must each be counted.
+ *
+ * With the decoder or de-bounce state shared between instances, the interleaved edges
+ * look like garbage to the one state machine, and one button's de-bounce swallows the
+ * other's press.
+ */
+
+#include "bench.h"
+
+#define KNOBS 4
+
+// One simulated knob, stepped by hand so that several can be interleaved edge by edge
+struct Knob {
+  uint8_t pinA, pinB, pinButton;
+  long steps;            // Still to go; positive turns right
+  uint8_t index;         // Position in the Gray code sequence
+
+  void step()
+  {
+    static const uint8_t sequence[4] = { 0b11, 0b01, 0b00, 0b10 };
+
+    if( steps == 0 )
+      return;
+
+    index = ( index + ( ( steps > 0 ) ? 1 : 3 ) ) & 0x03;
+    steps += ( steps > 0 ) ? -1 : 1;
+
+    RotaryEncoderHost::setPin( pinA, ( sequence[index] >> 1 ) & 0x01 );
+    RotaryEncoderHost::setPin( pinB, sequence[index] & 0x01 );
+  }
+};
+
+int main()
+{
+  RotaryEncoderHost::reset();
+
+  const long detents[KNOBS] = { 50, -50, 37, -13 };
+
+  Knob knobs[KNOBS];
+  RotaryEncoder *encoders[KNOBS];
+  int presses[KNOBS] = {};
+
+  for( int i = 0; i < KNOBS; i++ )
+  {
+    knobs[i] = { (uint8_t)( 4 + i * 3 ), (uint8_t)( 5 + i * 3 ), (uint8_t)( 6 + i * 3 ), detents[i] * RE_DEFAULT_STEPS, 0 };
+
+    encoders[i] = new RotaryEncoder( knobs[i].pinA, knobs[i].pinB, knobs[i].pinButton );
+    encoders[i]->setBoundaries( -1000, 1000 );
+    encoders[i]->onPressed( [&presses, i]( unsigned long ){ presses[i]++; } );
+    encoders[i]->begin();
+  }
+
+  // Every knob takes a step in the same microsecond, over and over
+  for( int round = 0; round < 50 * RE_DEFAULT_STEPS; round++ )
+  {
+    RotaryEncoderHost::advance( 500 );
+
+    for( int i = 0; i < KNOBS; i++ )
+      knobs[i].step();
+  }
+
+  // ...and all the buttons are pressed and released together, three times
+  for( int click = 0; click < 3; click++ )
+  {
+    for( int i = 0; i < KNOBS; i++ )
+      RotaryEncoderHost::setButton( knobs[i].pinButton, true );
+
+    RotaryEncoderHost::advance( 100000 );
+
+    for( int i = 0; i < KNOBS; i++ )
+      RotaryEncoderHost::setButton( knobs[i].pinButton, false );
+
+    RotaryEncoderHost::advance( 100000 );
+  }
+
+  RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+  for( int i = 0; i < KNOBS; i++ )
+  {
+    printf( "Encoder %d: value %ld (expected %ld), %d presses\n", i, encoders[i]->getEncoderValue(), detents[i], presses[i] );
+
+    CHECK_EQUAL( encoders[i]->getEncoderValue(), detents[i] );
+    CHECK_EQUAL( presses[i], 3 );
+  }
+
+  for( int i = 0; i < KNOBS; i++ )
+    delete encoders[i];
+
+  return benchResult();
+}
@@ -0,0 +1,124 @@
+/**
+ * `getPosition()` must count every step, however the value is clamped, with the time of
+ * the last one; split it into whole revolutions rounded down (so just left of zero is
+ * revolution -1, at its last step) and the step within the revolution; and keep counting
+ * right across the 32-bit limits, from wherever `resetPosition()` started it.
+ */
+
+#include "bench.h"
+
+#include <stdint.h>
+
+#define PIN_A 21
+#define PIN_B 22
+#define PIN_A2 25
+#define PIN_B2 26
+
+#define PER_REVOLUTION 80   // 20 detents of 4 steps
+#define STEP_US 1000
+
+// Expected revolutions and step within one, worked out the long way
+static void checkPosition( const EncoderPosition &position, int64_t count )
+{
+  int64_t revolutions = 0;
+
+  if( count >= 0 )
+    revolutions = count / PER_REVOLUTION;
+  else
+    revolutions = -( ( -count + PER_REVOLUTION - 1 ) / PER_REVOLUTION );
+
+  CHECK_EQUAL( position.count, count );
+  CHECK_EQUAL( position.revolutions, revolutions );
+  CHECK_EQUAL( position.step, count - revolutions * PER_REVOLUTION );
+}
+
+int main()
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( 0, 10 );
+  encoder.setCountsPerRevolution( PER_REVOLUTION );
+  encoder.begin();
+
+  // Steps from zero, and where each leaves the count
+  const long moves[] = { 79, 1, -81, -79, -1, 161, -240 };
+  int64_t count = 0;
+
+  for( long steps : moves )
+  {
+    RotaryEncoderHost::turn( PIN_A, PIN_B, steps, STEP_US );
+    count += steps;
+
+    uint32_t lastStep = (uint32_t)RotaryEncoderHost::now();
+
+    // Still; the timestamp stays with the last step
+    RotaryEncoderHost::advance( 50000 );
+
+    EncoderPosition position = encoder.getPosition();
+
+    printf( "%+5ld steps: count %lld, revolution %lld, step %lu, at %lu us\n", steps, (long long)position.count, (long long)position.revolutions, (unsigned long)position.step, (unsigned long)position.timestamp );
+
+    checkPosition( position, count );
+    CHECK_EQUAL( position.timestamp, lastStep );
+  }
+
+  // The value was clamped at both ends along the way; the position never is
+  RotaryEncoderHost::turn( PIN_A, PIN_B, 30 * RE_DEFAULT_STEPS, STEP_US );
+  count += 30 * RE_DEFAULT_STEPS;
+
+  CHECK_EQUAL( encoder.getEncoderValue(), 10 );
+  checkPosition( encoder.getPosition(), count );
+
+  // Back to zero, without touching the value
+  encoder.resetPosition();
+
+  checkPosition( encoder.getPosition(), 0 );
+  CHECK_EQUAL( encoder.getEncoderValue(), 10 );
+
+  // Across each 32-bit limit, both ways
+  const int64_t starts[] = { INT32_MAX - 3, (int64_t)INT32_MIN + 3, (int64_t)UINT32_MAX - 3, -(int64_t)UINT32_MAX + 3 };
+
+  for( int64_t start : starts )
+  {
+    long steps = ( start > 0 ) ? 8 : -8;
+
+    encoder.resetPosition( start );
+    RotaryEncoderHost::turn( PIN_A, PIN_B, steps, STEP_US );
+
+    EncoderPosition position = encoder.getPosition();
+
+    printf( "%lld %+ld steps: count %lld, revolution %lld, step %lu\n", (long long)start, steps, (long long)position.count, (long long)position.revolutions, (unsigned long)position.step );
+
+    checkPosition( position, start + steps );
+  }
+
+  // Without counts per revolution, just the count
+  encoder.setCountsPerRevolution( 0 );
+  encoder.resetPosition();
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -100, STEP_US );
+
+  EncoderPosition plain = encoder.getPosition();
+
+  CHECK_EQUAL( plain.count, -100 );
+  CHECK_EQUAL( plain.revolutions, 0 );
+  CHECK_EQUAL( plain.step, 0 );
+
+  // The pulse counter is read by `getPosition()`, so the timestamp is when it was read
+  RotaryEncoder counted( PIN_A2, PIN_B2 );
+  counted.setCountsPerRevolution( PER_REVOLUTION );
+  counted.begin( true, PCNT_BACKEND );
+
+  RotaryEncoderHost::turn( PIN_A2, PIN_B2, -85, STEP_US );
+  RotaryEncoderHost::advance( 50000 );
+
+  uint32_t readAt = (uint32_t)RotaryEncoderHost::now();
+  EncoderPosition position = counted.getPosition();
+
+  printf( "PCNT -85 steps: count %lld, revolution %lld, step %lu\n", (long long)position.count, (long long)position.revolutions, (unsigned long)position.step );
+
+  checkPosition( position, -85 );
+  CHECK_EQUAL( position.timestamp, readAt );
+
+  return benchResult();
+}
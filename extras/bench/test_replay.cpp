@@ -0,0 +1,97 @@
+/**
+ * Plays the captures in traces.h back through `RotaryEncoderHost::replay()`; each must
+ * end with the value and presses of the turn that was made while it was recorded, and
+ * the position must count every step the pin levels show, so a change to the decoder
+ * or the de-bounce that would have turned out differently on the same pins is caught.
+ *
+ * What the levels show is worked out here, from the quadrature sequence alone, and for
+ * all but the overspeed trace has to be the turn that was made; otherwise the trace
+ * itself is wrong.  The overspeed trace lost steps before the ISR ran, so the encoder
+ * can only be held to what the levels show.
+ */
+
+#include "bench.h"
+#include "traces.h"
+
+#define PIN_A 21
+#define PIN_B 22
+#define PIN_BUTTON 23
+
+// Levels of A and B (`RE_CAPTURE_A | RE_CAPTURE_B`) in the order a turn to the right goes through them
+static const uint8_t rightTurn[] = { 3, 1, 0, 2 };
+
+static int quadrant( uint32_t entry )
+{
+  for( int i = 0; i < 4; i++ )
+    if( rightTurn[i] == ( entry & ( RE_CAPTURE_A | RE_CAPTURE_B ) ) )
+      return i;
+
+  return 0;
+}
+
+// Steps the levels show: one either way for a neighbouring quadrant, none for a jump of two
+static int64_t stepsShown( const RecordedTrace &trace, uint32_t *jumps )
+{
+  int64_t steps = 0;
+  *jumps = 0;
+
+  for( size_t i = 1; i < trace.count; i++ )
+  {
+    int move = ( quadrant( trace.entries[i] ) - quadrant( trace.entries[i - 1] ) + 4 ) % 4;
+
+    if( move == 1 )
+      steps++;
+    else if( move == 3 )
+      steps--;
+    else if( move == 2 )
+      ( *jumps )++;
+  }
+
+  return steps;
+}
+
+int main()
+{
+  for( const RecordedTrace &trace : recordedTraces )
+  {
+    uint32_t jumps;
+    int64_t steps = stepsShown( trace, &jumps );
+
+    if( !trace.overspeed )
+    {
+      CHECK_EQUAL( steps, trace.detents * RE_DEFAULT_STEPS );
+      CHECK_EQUAL( jumps, 0 );
+    }
+    else
+    {
+      // Otherwise it isn't showing what it's meant to
+      CHECK( steps != trace.detents * RE_DEFAULT_STEPS );
+      CHECK( jumps > 0 );
+    }
+
+    RotaryEncoderHost::reset();
+
+    RotaryEncoder encoder( PIN_A, PIN_B, PIN_BUTTON );
+    encoder.setBoundaries( -1000, 1000 );
+
+    long presses = 0;
+    encoder.onPressed( [&presses]( unsigned long ){ presses++; } );
+    encoder.begin();
+
+    uint64_t took = RotaryEncoderHost::replay( trace.entries, trace.count, PIN_A, PIN_B, PIN_BUTTON );
+    RotaryEncoderHost::advance( 300000 );
+
+    printf( "%-14s %4u entries over %7llu us, turned %3ld: value %4ld, position %4lld (%lld shown, %u jumps), %ld presses\n",
+      trace.name, (unsigned int)trace.count, (unsigned long long)took, trace.detents, encoder.getEncoderValue(),
+      (long long)encoder.getPosition().count, (long long)steps, (unsigned int)jumps, presses );
+
+    CHECK_EQUAL( encoder.getPosition().count, steps );
+    CHECK_EQUAL( encoder.getEncoderValue(), (long)( steps / RE_DEFAULT_STEPS ) );
+    CHECK_EQUAL( presses, trace.presses );
+
+    if( !trace.overspeed )
+      CHECK_EQUAL( encoder.getEncoderValue(), trace.detents );
+  }
+
+  return benchResult();
+}
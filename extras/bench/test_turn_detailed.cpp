@@ -0,0 +1,49 @@
+/**
+ * `onTurnedDetailed()` must report the direction of the last detent, not of the last
+ * step: a detent to the left followed by half a step to the right (the knob rocking
+ * back before `loop()` runs) is still a turn to the left.
+ */
+
+#include "bench.h"
+
+#define PIN_A 21
+#define PIN_B 22
+
+int main()
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -100, 100 );
+
+  EncoderTurn last = {};
+  int calls = 0;
+  encoder.onTurnedDetailed( [&last, &calls]( const EncoderTurn &turn ){ last = turn; calls++; } );
+  encoder.begin();
+
+  // One detent left, then two steps (half a detent) right, within one loop interval
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -RE_DEFAULT_STEPS, 1000 );
+  RotaryEncoderHost::turn( PIN_A, PIN_B, RE_DEFAULT_STEPS / 2, 1000 );
+  RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+  printf( "Left, then half right: delta %ld, detents %lu, direction %d\n", last.delta, (unsigned long)last.detents, last.direction );
+
+  CHECK_EQUAL( calls, 1 );
+  CHECK_EQUAL( last.delta, -1 );
+  CHECK_EQUAL( last.detents, 1 );
+  CHECK_EQUAL( last.direction, -1 );
+
+  // Back to where the detent was, then two detents right
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -RE_DEFAULT_STEPS / 2, 1000 );
+  RotaryEncoderHost::turn( PIN_A, PIN_B, 2 * RE_DEFAULT_STEPS, 1000 );
+  RotaryEncoderHost::advance( RE_LOOP_INTERVAL );
+
+  printf( "Two right:             delta %ld, detents %lu, direction %d\n", last.delta, (unsigned long)last.detents, last.direction );
+
+  CHECK_EQUAL( calls, 2 );
+  CHECK_EQUAL( last.delta, 2 );
+  CHECK_EQUAL( last.detents, 2 );
+  CHECK_EQUAL( last.direction, 1 );
+
+  return benchResult();
+}
@@ -0,0 +1,228 @@
+/**
+ * `setTurnedPolicy()` must hold `onTurned()` back exactly as asked, during a burst of
+ * detents: with a rate limit, leading only calls at the start of each interval and may
+ * drop the final value, trailing only calls at the end of each interval and always
+ * reports the final value, and both call at both ends; a settle time waits for the
+ * knob to be still; and `minDelta` holds back small changes until they add up, without
+ * keeping the dispatcher busy in the meantime.
+ *
+ * Uses `DISPATCH_NOTIFY`, whose task wakes when a held-back change comes due, so the
+ * times are the policy's own (to the 1 ms tick) rather than the loop timer's.
+ */
+
+#include "bench.h"
+
+#include <vector>
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define BURST 20          // Detents in a burst
+#define SPACING_MS 10     // Between them
+#define SLACK_US 2000     // Tick rounding of the dispatcher's wait
+
+typedef struct {
+  int64_t at;             // Microseconds after the burst started
+  long value;
+} Call;
+
+static std::vector<Call> calls;
+static uint64_t firstDetent;
+
+static RotaryEncoder *start( uint32_t minIntervalMs, long minDelta, uint32_t settleMs, bool leading, bool trailing )
+{
+  RotaryEncoderHost::reset();
+  calls.clear();
+
+  RotaryEncoder *encoder = new RotaryEncoder( PIN_A, PIN_B );
+  encoder->setBoundaries( -1000, 1000 );
+  encoder->setDispatchMode( DISPATCH_NOTIFY );
+  encoder->setTurnedPolicy( minIntervalMs, minDelta, settleMs, leading, trailing );
+  encoder->onTurned( []( long value ){ calls.push_back( { (int64_t)( RotaryEncoderHost::now() - firstDetent ), value } ); } );
+  encoder->begin();
+
+  RotaryEncoderHost::advance( 100000 );
+
+  return encoder;
+}
+
+// `count` detents, each a quick flick, `SPACING_MS` apart; then a second to let it all out
+static void burst( int count )
+{
+  // From the start of the first flick, which is done well within a tick
+  firstDetent = RotaryEncoderHost::now();
+
+  for( int i = 0; i < count; i++ )
+  {
+    RotaryEncoderHost::turn( PIN_A, PIN_B, RE_DEFAULT_STEPS, 100 );
+    RotaryEncoderHost::advance( SPACING_MS * 1000 - RE_DEFAULT_STEPS * 100 );
+  }
+
+  RotaryEncoderHost::advance( 1000000 );
+}
+
+static void show( const char *name )
+{
+  printf( "  %-26s", name );
+  for( const Call &call : calls )
+    printf( " %ld@%.0f", call.value, call.at / 1000.0 );
+  printf( "\n" );
+}
+
+// The calls must be at least `interval` apart (less the tick rounding)
+static void checkSpacing( uint32_t intervalMs )
+{
+  for( size_t i = 1; i < calls.size(); i++ )
+    CHECK( calls[i].at - calls[i - 1].at >= (int64_t)intervalMs * 1000 - SLACK_US );
+}
+
+static void checkNear( int64_t at, int64_t expectedMs )
+{
+  CHECK( at >= expectedMs * 1000 && at <= expectedMs * 1000 + SLACK_US );
+}
+
+int main()
+{
+  printf( "%d detents %d ms apart; value@ms after the burst started, of each call:\n", BURST, SPACING_MS );
+
+  // No policy: every detent is its own call
+  RotaryEncoder *encoder = start( 0, 0, 0, true, true );
+  burst( BURST );
+  show( "none" );
+
+  CHECK_EQUAL( calls.size(), BURST );
+  CHECK_EQUAL( calls.back().value, BURST );
+  delete encoder;
+
+  // 50 ms, leading and trailing: straight away, then at the end of every interval with a change
+  encoder = start( 50, 0, 0, true, true );
+  burst( BURST );
+  show( "50 ms, leading + trailing" );
+
+  CHECK( calls.size() >= 2 );
+  checkSpacing( 50 );
+
+  if( calls.size() >= 2 )
+  {
+    checkNear( calls.front().at, 0 );
+    CHECK_EQUAL( calls.front().value, 1 );
+    checkNear( calls[1].at, 50 );
+    CHECK_EQUAL( calls.back().value, BURST );
+  }
+
+  // Fewer than a call per detent, but more than one per interval would allow
+  CHECK( calls.size() <= ( BURST * SPACING_MS ) / 50 + 2 );
+  delete encoder;
+
+  // Leading only: straight away, and then only the first change after each interval
+  encoder = start( 50, 0, 0, true, false );
+  burst( BURST );
+  show( "50 ms, leading" );
+
+  CHECK( calls.size() >= 2 );
+  checkSpacing( 50 );
+
+  if( !calls.empty() )
+  {
+    checkNear( calls.front().at, 0 );
+    CHECK_EQUAL( calls.front().value, 1 );
+
+    // Nothing at the end of an interval: every call is right on a detent
+    for( const Call &call : calls )
+      CHECK_EQUAL( ( call.at + 500 ) / 1000 % SPACING_MS, 0 );
+
+    // The last detents came within the interval of the last call, and were dropped
+    CHECK( calls.back().value < BURST );
+  }
+
+  delete encoder;
+
+  // Trailing only: nothing at the start, the latest value at the end of each interval
+  encoder = start( 50, 0, 0, false, true );
+  burst( BURST );
+  show( "50 ms, trailing" );
+
+  CHECK( calls.size() >= 2 );
+  checkSpacing( 50 );
+
+  if( !calls.empty() )
+  {
+    checkNear( calls.front().at, 50 );
+    CHECK_EQUAL( calls.front().value, 5 + 1 );
+    CHECK_EQUAL( calls.back().value, BURST );
+  }
+
+  delete encoder;
+
+  // Settle: one call, once the knob has been still for 30 ms
+  encoder = start( 0, 0, 30, true, true );
+  burst( BURST );
+  show( "settle 30 ms" );
+
+  CHECK_EQUAL( calls.size(), 1 );
+
+  if( calls.size() == 1 )
+  {
+    checkNear( calls[0].at, ( BURST - 1 ) * SPACING_MS + 30 );
+    CHECK_EQUAL( calls[0].value, BURST );
+  }
+
+  delete encoder;
+
+  // A pause longer than the settle time in the middle of the burst: two calls
+  encoder = start( 0, 0, 30, true, true );
+  burst( 5 );
+  burst( 5 );
+  show( "settle 30 ms, two bursts" );
+
+  CHECK_EQUAL( calls.size(), 2 );
+
+  if( calls.size() == 2 )
+  {
+    CHECK_EQUAL( calls[0].value, 5 );
+    CHECK_EQUAL( calls[1].value, 10 );
+  }
+
+  delete encoder;
+
+  // minDelta 3: every third detent, and the rest only once they add up
+  encoder = start( 0, 3, 0, true, true );
+  burst( BURST );
+  show( "minDelta 3" );
+
+  CHECK_EQUAL( calls.size(), BURST / 3 );
+
+  for( size_t i = 0; i < calls.size(); i++ )
+    CHECK_EQUAL( calls[i].value, 3 * ( (long)i + 1 ) );
+
+  // Two held back: nothing until a third, and the dispatcher sleeps in between
+  uint32_t wakes = RotaryEncoderHost::taskWakeCount();
+  RotaryEncoderHost::advance( 5000000 );
+  wakes = RotaryEncoderHost::taskWakeCount() - wakes;
+
+  printf( "  %-26s %u dispatcher wakes in 5 s with %ld held back\n", "", wakes, encoder->getEncoderValue() - calls.back().value );
+
+  CHECK_EQUAL( wakes, 0 );
+  CHECK_EQUAL( calls.size(), BURST / 3 );
+
+  burst( 1 );
+
+  CHECK_EQUAL( calls.size(), BURST / 3 + 1 );
+  CHECK_EQUAL( calls.back().value, BURST + 1 );
+
+  // ...and the other way, it's the distance from the last value reported that counts
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -2 * RE_DEFAULT_STEPS, 100 );
+  RotaryEncoderHost::advance( 1000000 );
+
+  CHECK_EQUAL( calls.size(), BURST / 3 + 1 );
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -RE_DEFAULT_STEPS, 100 );
+  RotaryEncoderHost::advance( 1000000 );
+
+  CHECK_EQUAL( calls.size(), BURST / 3 + 2 );
+  CHECK_EQUAL( calls.back().value, BURST + 1 - 3 );
+
+  delete encoder;
+
+  return benchResult();
+}
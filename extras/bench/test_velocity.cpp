@@ -0,0 +1,117 @@
+/**
+ * `getVelocity()` must read the step rate of a steady turn, in steps per second, with
+ * the sign of the direction, and start over (rather than average across) when the knob
+ * reverses; fall off between steps as if the next were just about to come, and drop to
+ * 0 after the timeout of `setVelocityTimeout()`; follow a change of speed by 1/2^
+ * `RE_VELOCITY_SMOOTHING` per step; and `getRPM()` must scale it by the counts per
+ * revolution.
+ */
+
+#include "bench.h"
+
+#include <math.h>
+
+#define PIN_A 21
+#define PIN_B 22
+
+#define PER_REVOLUTION 80
+
+#define CHECK_NEAR( actual, expected ) \
+  do { double _a = ( actual ), _e = ( expected ); if( fabs( _a - _e ) > fabs( _e ) * 0.001 + 0.001 ) { fprintf( stderr, "%s:%d: check failed: %s is %.3f, expected %.3f\n", __FILE__, __LINE__, #actual, _a, _e ); benchFailures++; } } while( 0 )
+
+int main()
+{
+  RotaryEncoderHost::reset();
+
+  RotaryEncoder encoder( PIN_A, PIN_B );
+  encoder.setBoundaries( -100000, 100000 );
+  encoder.setCountsPerRevolution( PER_REVOLUTION );
+  encoder.begin();
+
+  CHECK_EQUAL( encoder.getVelocity(), 0 );
+
+  // A steady 1000 steps per second to the right: 12.5 revolutions per second
+  RotaryEncoderHost::turn( PIN_A, PIN_B, 200, 1000 );
+
+  printf( "1000 steps/s right:   %9.2f steps/s, %7.2f RPM\n", encoder.getVelocity(), encoder.getRPM() );
+
+  CHECK_NEAR( encoder.getVelocity(), 1000 );
+  CHECK_NEAR( encoder.getRPM(), 1000.0 * 60 / PER_REVOLUTION );
+
+  // Reversed at 2000 steps per second: the first step left has nothing to average yet...
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -1, 500 );
+
+  printf( "first step back:      %9.2f steps/s\n", encoder.getVelocity() );
+
+  CHECK_EQUAL( encoder.getVelocity(), 0 );
+
+  // ...and the next one is the new speed, nothing left over from the old one
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -1, 500 );
+
+  printf( "second step back:     %9.2f steps/s\n", encoder.getVelocity() );
+
+  CHECK_NEAR( encoder.getVelocity(), -2000 );
+
+  RotaryEncoderHost::turn( PIN_A, PIN_B, -100, 500 );
+
+  CHECK_NEAR( encoder.getVelocity(), -2000 );
+  CHECK_NEAR( encoder.getRPM(), -2000.0 * 60 / PER_REVOLUTION );
+
+  // Between steps, it falls off once the average period has gone by without one...
+  RotaryEncoderHost::advance( 400 );
+  CHECK_NEAR( encoder.getVelocity(), -2000 );
+
+  RotaryEncoderHost::advance( 2600 );
+
+  printf( "3 ms without a step:  %9.2f steps/s\n", encoder.getVelocity() );
+
+  CHECK_NEAR( encoder.getVelocity(), -1000000.0 / 3000 );
+
+  // ...and is 0 once the (default) timeout is up
+  RotaryEncoderHost::advance( RE_VELOCITY_TIMEOUT_MS * 1000 - 3000 - 1 );
+  CHECK( encoder.getVelocity() < 0 );
+
+  RotaryEncoderHost::advance( 1 );
+
+  printf( "after %u ms:          %9.2f steps/s\n", RE_VELOCITY_TIMEOUT_MS, encoder.getVelocity() );
+
+  CHECK_EQUAL( encoder.getVelocity(), 0 );
+  CHECK_EQUAL( encoder.getRPM(), 0 );
+
+  // A shorter timeout
+  encoder.setVelocityTimeout( 100 );
+  RotaryEncoderHost::turn( PIN_A, PIN_B, 10, 1000 );
+
+  RotaryEncoderHost::advance( 99000 );
+  CHECK_NEAR( encoder.getVelocity(), 1000000.0 / 99000 );
+
+  RotaryEncoderHost::advance( 1000 );
+  CHECK_EQUAL( encoder.getVelocity(), 0 );
+
+  // From 1 ms to 0.5 ms per step: each step moves the average period a quarter of the way
+  RotaryEncoderHost::turn( PIN_A, PIN_B, 50, 1000 );
+
+  double period = 1000;
+
+  printf( "1 ms, then 0.5 ms per step:" );
+
+  for( int i = 1; i <= 20; i++ )
+  {
+    RotaryEncoderHost::turn( PIN_A, PIN_B, 1, 500 );
+    period += ( 500 - period ) / ( 1 << RE_VELOCITY_SMOOTHING );
+
+    if( i <= 4 || i % 5 == 0 )
+      printf( " %.0f", encoder.getVelocity() );
+
+    CHECK_NEAR( encoder.getVelocity(), 1000000.0 / period );
+  }
+
+  printf( " steps/s\n" );
+
+  // Without counts per revolution, there's no RPM
+  encoder.setCountsPerRevolution( 0 );
+  CHECK( encoder.getVelocity() > 0 );
+  CHECK_EQUAL( encoder.getRPM(), 0 );
+
+  return benchResult();
+}
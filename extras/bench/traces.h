@@ -0,0 +1,164 @@
+#ifndef _traces_h
+#define _traces_h
+
+/**
+ * Captures for test_replay, each with the turn that was made while it was recorded.
+ *
+ * They were recorded with `RotaryEncoder::startCapture()` on the host, with the turn and
+ * the noise given in each comment played in, by an encoder on A = 21, B = 22 and
+ * button = 23.  What an encoder should make of each is the turn itself, not anything
+ * the library said at the time: `detents` and `presses` come from the comment, and
+ * test_replay checks the pin levels against them with a decoder of its own before it
+ * checks the encoder.  The format is the same as a capture from the board, so one that
+ * shows a problem there can be added the same way.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// A clean turn: 10 detents right, then 4 left, one step every 2 ms
+static const uint32_t traceClean[] = {
+  0x00111707, 0x00119405, 0x00121104, 0x00128e06, 0x00130b07, 0x00138805,
+  0x00140504, 0x00148206, 0x0014ff07, 0x00157c05, 0x0015f904, 0x00167606,
+  0x0016f307, 0x00177005, 0x0017ed04, 0x00186a06, 0x0018e707, 0x00196405,
+  0x0019e104, 0x001a5e06, 0x001adb07, 0x001b5805, 0x001bd504, 0x001c5206,
+  0x001ccf07, 0x001d4c05, 0x001dc904, 0x001e4606, 0x001ec307, 0x001f4005,
+  0x001fbd04, 0x00203a06, 0x0020b707, 0x00213405, 0x0021b104, 0x00222e06,
+  0x0022ab07, 0x00232805, 0x0023a504, 0x00242206, 0x00249f07, 0x00315106,
+  0x0031ce04, 0x00324b05, 0x0032c807, 0x00334506, 0x0033c204, 0x00343f05,
+  0x0034bc07, 0x00353906, 0x0035b604, 0x00363305, 0x0036b007, 0x00372d06,
+  0x0037aa04, 0x00382705, 0x0038a407
+};
+
+// Worn contacts: every step bounces twice, 30 us apart; 12 detents right, then 5 left
+static const uint32_t traceBounce[] = {
+  0x00111707, 0x001174c5, 0x001176a7, 0x00117885, 0x00117a67, 0x00117c45,
+  0x0011da04, 0x0011dbe5, 0x0011ddc4, 0x0011dfa5, 0x0011e184, 0x00123f46,
+  0x00124124, 0x00124306, 0x001244e4, 0x001246c6, 0x0012a487, 0x0012a666,
+  0x0012a847, 0x0012aa26, 0x0012ac07, 0x001309c5, 0x00130ba7, 0x00130d85,
+  0x00130f67, 0x00131145, 0x00136f04, 0x001370e5, 0x001372c4, 0x001374a5,
+  0x00137684, 0x0013d446, 0x0013d624, 0x0013d806, 0x0013d9e4, 0x0013dbc6,
+  0x00143987, 0x00143b66, 0x00143d47, 0x00143f26, 0x00144107, 0x00149ec5,
+  0x0014a0a7, 0x0014a285, 0x0014a467, 0x0014a645, 0x00150404, 0x001505e5,
+  0x001507c4, 0x001509a5, 0x00150b84, 0x00156946, 0x00156b24, 0x00156d06,
+  0x00156ee4, 0x001570c6, 0x0015ce87, 0x0015d066, 0x0015d247, 0x0015d426,
+  0x0015d607, 0x001633c5, 0x001635a7, 0x00163785, 0x00163967, 0x00163b45,
+  0x00169904, 0x00169ae5, 0x00169cc4, 0x00169ea5, 0x0016a084, 0x0016fe46,
+  0x00170024, 0x00170206, 0x001703e4, 0x001705c6, 0x00176387, 0x00176566,
+  0x00176747, 0x00176926, 0x00176b07, 0x0017c8c5, 0x0017caa7, 0x0017cc85,
+  0x0017ce67, 0x0017d045, 0x00182e04, 0x00182fe5, 0x001831c4, 0x001833a5,
+  0x00183584, 0x00189346, 0x00189524, 0x00189706, 0x001898e4, 0x00189ac6,
+  0x0018f887, 0x0018fa66, 0x0018fc47, 0x0018fe26, 0x00190007, 0x00195dc5,
+  0x00195fa7, 0x00196185, 0x00196367, 0x00196545, 0x0019c304, 0x0019c4e5,
+  0x0019c6c4, 0x0019c8a5, 0x0019ca84, 0x001a2846, 0x001a2a24, 0x001a2c06,
+  0x001a2de4, 0x001a2fc6, 0x001a8d87, 0x001a8f66, 0x001a9147, 0x001a9326,
+  0x001a9507, 0x001af2c5, 0x001af4a7, 0x001af685, 0x001af867, 0x001afa45,
+  0x001b5804, 0x001b59e5, 0x001b5bc4, 0x001b5da5, 0x001b5f84, 0x001bbd46,
+  0x001bbf24, 0x001bc106, 0x001bc2e4, 0x001bc4c6, 0x001c2287, 0x001c2466,
+  0x001c2647, 0x001c2826, 0x001c2a07, 0x001c87c5, 0x001c89a7, 0x001c8b85,
+  0x001c8d67, 0x001c8f45, 0x001ced04, 0x001ceee5, 0x001cf0c4, 0x001cf2a5,
+  0x001cf484, 0x001d5246, 0x001d5424, 0x001d5606, 0x001d57e4, 0x001d59c6,
+  0x001db787, 0x001db966, 0x001dbb47, 0x001dbd26, 0x001dbf07, 0x001e1cc5,
+  0x001e1ea7, 0x001e2085, 0x001e2267, 0x001e2445, 0x001e8204, 0x001e83e5,
+  0x001e85c4, 0x001e87a5, 0x001e8984, 0x001ee746, 0x001ee924, 0x001eeb06,
+  0x001eece4, 0x001eeec6, 0x001f4c87, 0x001f4e66, 0x001f5047, 0x001f5226,
+  0x001f5407, 0x001fb1c5, 0x001fb3a7, 0x001fb585, 0x001fb767, 0x001fb945,
+  0x00201704, 0x002018e5, 0x00201ac4, 0x00201ca5, 0x00201e84, 0x00207c46,
+  0x00207e24, 0x00208006, 0x002081e4, 0x002083c6, 0x0020e187, 0x0020e366,
+  0x0020e547, 0x0020e726, 0x0020e907, 0x002146c5, 0x002148a7, 0x00214a85,
+  0x00214c67, 0x00214e45, 0x0021ac04, 0x0021ade5, 0x0021afc4, 0x0021b1a5,
+  0x0021b384, 0x00221146, 0x00221324, 0x00221506, 0x002216e4, 0x002218c6,
+  0x00227687, 0x00227866, 0x00227a47, 0x00227c26, 0x00227e07, 0x0022dbc5,
+  0x0022dda7, 0x0022df85, 0x0022e167, 0x0022e345, 0x00234104, 0x002342e5,
+  0x002344c4, 0x002346a5, 0x00234884, 0x0023a646, 0x0023a824, 0x0023aa06,
+  0x0023abe4, 0x0023adc6, 0x00240b87, 0x00240d66, 0x00240f47, 0x00241126,
+  0x00241307, 0x0030a5c6, 0x0030a7a7, 0x0030a986, 0x0030ab67, 0x0030ad46,
+  0x00310b04, 0x00310ce6, 0x00310ec4, 0x003110a6, 0x00311284, 0x00317045,
+  0x00317224, 0x00317405, 0x003175e4, 0x003177c5, 0x0031d587, 0x0031d765,
+  0x0031d947, 0x0031db25, 0x0031dd07, 0x00323ac6, 0x00323ca7, 0x00323e86,
+  0x00324067, 0x00324246, 0x0032a004, 0x0032a1e6, 0x0032a3c4, 0x0032a5a6,
+  0x0032a784, 0x00330545, 0x00330724, 0x00330905, 0x00330ae4, 0x00330cc5,
+  0x00336a87, 0x00336c65, 0x00336e47, 0x00337025, 0x00337207, 0x0033cfc6,
+  0x0033d1a7, 0x0033d386, 0x0033d567, 0x0033d746, 0x00343504, 0x003436e6,
+  0x003438c4, 0x00343aa6, 0x00343c84, 0x00349a45, 0x00349c24, 0x00349e05,
+  0x00349fe4, 0x0034a1c5, 0x0034ff87, 0x00350165, 0x00350347, 0x00350525,
+  0x00350707, 0x003564c6, 0x003566a7, 0x00356886, 0x00356a67, 0x00356c46,
+  0x0035ca04, 0x0035cbe6, 0x0035cdc4, 0x0035cfa6, 0x0035d184, 0x00362f45,
+  0x00363124, 0x00363305, 0x003634e4, 0x003636c5, 0x00369487, 0x00369665,
+  0x00369847, 0x00369a25, 0x00369c07, 0x0036f9c6, 0x0036fba7, 0x0036fd86,
+  0x0036ff67, 0x00370146, 0x00375f04, 0x003760e6, 0x003762c4, 0x003764a6,
+  0x00376684, 0x0037c445, 0x0037c624, 0x0037c805, 0x0037c9e4, 0x0037cbc5,
+  0x00382987, 0x00382b65, 0x00382d47, 0x00382f25, 0x00383107
+};
+
+// A spin faster than the ISR, modelled at 8 us: 30 detents right, one step every 3 us, so up to three steps land
+// between two runs of the ISR; three steps right look like one left, and two like a jump the decoder can't place
+static const uint32_t traceFastSpin[] = {
+  0x00111707, 0x00111735, 0x001117b6, 0x00111834, 0x001118b7, 0x00111936,
+  0x001119b4, 0x00111a37, 0x00111ab6, 0x00111b34, 0x00111bb7, 0x00111c36,
+  0x00111cb4, 0x00111d37, 0x00111db6, 0x00111e34, 0x00111eb7, 0x00111f36,
+  0x00111fb4, 0x00112037, 0x001120b6, 0x00112134, 0x001121b7, 0x00112236,
+  0x001122b4, 0x00112337, 0x001123b6, 0x00112434, 0x001124b7, 0x00112536,
+  0x001125b4, 0x00112637, 0x001126b6, 0x00112734, 0x001127b7, 0x00112836,
+  0x001128b4, 0x00112937, 0x001129b6, 0x00112a34, 0x00112ab7, 0x00112b36,
+  0x00112bb4, 0x00112c37, 0x00112cb6, 0x00112d34, 0x00112db7, 0x00112e37
+};
+
+// A bouncy click between turns: 3 detents right, press and release with 4 bounces 500 us apart, 2 detents left
+static const uint32_t traceClick[] = {
+  0x00111707, 0x0011d285, 0x0011f1c7, 0x00121105, 0x00123047, 0x00124f85,
+  0x00126ec7, 0x00128e05, 0x0012ad47, 0x0012cc85, 0x00138804, 0x0013a745,
+  0x0013c684, 0x0013e5c5, 0x00140504, 0x00142445, 0x00144384, 0x001462c5,
+  0x00148204, 0x00153d86, 0x00155cc4, 0x00157c06, 0x00159b44, 0x0015ba86,
+  0x0015d9c4, 0x0015f906, 0x00161844, 0x00163786, 0x0016f307, 0x00171246,
+  0x00173187, 0x001750c6, 0x00177007, 0x00178f46, 0x0017ae87, 0x0017cdc6,
+  0x0017ed07, 0x0018a885, 0x0018c7c7, 0x0018e705, 0x00190647, 0x00192585,
+  0x001944c7, 0x00196405, 0x00198347, 0x0019a285, 0x001a5e04, 0x001a7d45,
+  0x001a9c84, 0x001abbc5, 0x001adb04, 0x001afa45, 0x001b1984, 0x001b38c5,
+  0x001b5804, 0x001c1386, 0x001c32c4, 0x001c5206, 0x001c7144, 0x001c9086,
+  0x001cafc4, 0x001ccf06, 0x001cee44, 0x001d0d86, 0x001dc907, 0x001de846,
+  0x001e0787, 0x001e26c6, 0x001e4607, 0x001e6546, 0x001e8487, 0x001ea3c6,
+  0x001ec307, 0x001f7e85, 0x001f9dc7, 0x001fbd05, 0x001fdc47, 0x001ffb85,
+  0x00201ac7, 0x00203a05, 0x00205947, 0x00207885, 0x00213404, 0x00215345,
+  0x00217284, 0x002191c5, 0x0021b104, 0x0021d045, 0x0021ef84, 0x00220ec5,
+  0x00222e04, 0x0022e986, 0x002308c4, 0x00232806, 0x00234744, 0x00236686,
+  0x002385c4, 0x0023a506, 0x0023c444, 0x0023e386, 0x00249f07, 0x0024be46,
+  0x0024dd87, 0x0024fcc6, 0x00251c07, 0x00253b46, 0x00255a87, 0x002579c6,
+  0x00259907, 0x003e030b, 0x003e224f, 0x003e418b, 0x003e60cf, 0x003e800b,
+  0x003e9f4f, 0x003ebe8b, 0x003eddcf, 0x003efd0b, 0x005c490f, 0x005c684b,
+  0x005c878f, 0x005ca6cb, 0x005cc60f, 0x005ce54b, 0x005d048f, 0x005d23cb,
+  0x005d430f, 0x00766886, 0x007687c7, 0x0076a706, 0x0076c647, 0x0076e586,
+  0x007704c7, 0x00772406, 0x00774347, 0x00776286, 0x00781e04, 0x00783d46,
+  0x00785c84, 0x00787bc6, 0x00789b04, 0x0078ba46, 0x0078d984, 0x0078f8c6,
+  0x00791804, 0x0079d385, 0x0079f2c4, 0x007a1205, 0x007a3144, 0x007a5085,
+  0x007a6fc4, 0x007a8f05, 0x007aae44, 0x007acd85, 0x007b8907, 0x007ba845,
+  0x007bc787, 0x007be6c5, 0x007c0607, 0x007c2545, 0x007c4487, 0x007c63c5,
+  0x007c8307, 0x007d3e86, 0x007d5dc7, 0x007d7d06, 0x007d9c47, 0x007dbb86,
+  0x007ddac7, 0x007dfa06, 0x007e1947, 0x007e3886, 0x007ef404, 0x007f1346,
+  0x007f3284, 0x007f51c6, 0x007f7104, 0x007f9046, 0x007faf84, 0x007fcec6,
+  0x007fee04, 0x0080a985, 0x0080c8c4, 0x0080e805, 0x00810744, 0x00812685,
+  0x008145c4, 0x00816505, 0x00818444, 0x0081a385, 0x00825f07, 0x00827e45,
+  0x00829d87, 0x0082bcc5, 0x0082dc07, 0x0082fb45, 0x00831a87, 0x008339c5,
+  0x00835907
+};
+
+typedef struct {
+  const char *name;
+  const uint32_t *entries;
+  size_t count;
+  long detents;           // Net turn made, right positive: what `getEncoderValue()` should end on
+  long presses;           // Times the button was pressed: what `onPressed()` should be called
+  bool overspeed;         // Steps were lost before the ISR saw them, so the levels can't show `detents`
+} RecordedTrace;
+
+#define TRACE( entries, detents, presses, overspeed ) \
+  { #entries, entries, sizeof( entries ) / sizeof( entries[0] ), detents, presses, overspeed }
+
+static const RecordedTrace recordedTraces[] = {
+  TRACE( traceClean,    10 - 4, 0, false ),
+  TRACE( traceBounce,   12 - 5, 0, false ),
+  TRACE( traceFastSpin, 30,     0, true ),
+  TRACE( traceClick,    3 - 2,  1, false )
+};
+
+#endif
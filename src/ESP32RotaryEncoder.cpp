@@ -1,5 +1,14 @@
 #include "ESP32RotaryEncoder.h"
 
+#include <algorithm>
+
+// A statement that's only compiled in with `RE_ENABLE_STATS`
+#if RE_ENABLE_STATS
+  #define RE_STATS( statement ) statement
+#else
+  #define RE_STATS( statement )
+#endif
+
 RotaryEncoder::RotaryEncoder( uint8_t encoderPinA, uint8_t encoderPinB, int8_t encoderPinButton, int8_t encoderPinVcc, uint8_t encoderSteps )
 {
   this->encoderPinA      = encoderPinA;
@@ -7,6 +16,12 @@ RotaryEncoder::RotaryEncoder( uint8_t encoderPinA, uint8_t encoderPinB, int8_t e
   this->encoderPinButton = encoderPinButton;
   this->encoderPinVcc    = encoderPinVcc;
   this->encoderTripPoint = encoderSteps - 1;
+  this->decodeTripPoint  = encoderTripPoint;
+
+  for( size_t i = 0; i < RE_ACCEL_BUCKETS; i++ )
+    accelerationMultipliers[i] = 1;
+
+  buildAccelerationTable();
 
   ESP_LOGD( LOG_TAG, "Initialized: A = %u, B = %u, Button = %i, VCC = %i, Steps = %u", encoderPinA, encoderPinB, encoderPinButton, encoderPinVcc, encoderSteps );
 }
@@ -15,8 +30,31 @@ RotaryEncoder::~RotaryEncoder()
 {
   detachInterrupts();
 
-  esp_timer_stop( loopTimer );
-  esp_timer_delete( loopTimer );
+  endCounter();
+
+  if( managed )
+    RotaryEncoderManager::remove( *this );
+
+  if( dispatchTaskOwned )
+    vTaskDelete( dispatchTask );
+
+  if( loopTimer != NULL )
+  {
+    esp_timer_stop( loopTimer );
+    esp_timer_delete( loopTimer );
+  }
+
+  if( gestureTimer != NULL )
+  {
+    esp_timer_stop( gestureTimer );
+    esp_timer_delete( gestureTimer );
+  }
+
+  if( debounceTimer != NULL )
+  {
+    esp_timer_stop( debounceTimer );
+    esp_timer_delete( debounceTimer );
+  }
 }
 
 void RotaryEncoder::setEncoderType( EncoderType type )
@@ -48,388 +86,1961 @@ void RotaryEncoder::setEncoderType( EncoderType type )
 
 void RotaryEncoder::setBoundaries( long minValue, long maxValue, bool circleValues )
 {
-  portENTER_CRITICAL( &mux );
-
   if( minValue > maxValue )
     ESP_LOGW( LOG_TAG, "Minimum value (%ld) is greater than maximum value (%ld); behavior is undefined.", minValue, maxValue );
 
-  setMinValue( minValue );
-  setMaxValue( maxValue );
-  setCircular( circleValues );
+  ESP_LOGD( LOG_TAG, "Boundaries %ld...%ld, %s circular", minValue, maxValue, ( circleValues ? "are" : "are not" ) );
+
+  portENTER_CRITICAL( &mux );
+
+  this->minEncoderValue = minValue;
+  this->maxEncoderValue = maxValue;
+  this->circleValues = circleValues;
+
+  addToValue( 0 );  // Bring the current value into the new range
 
   portEXIT_CRITICAL( &mux );
 }
 
 void RotaryEncoder::setMinValue( long minValue )
 {
-  portENTER_CRITICAL( &mux );
-
   ESP_LOGD( LOG_TAG, "minValue = %ld", minValue );
 
+  portENTER_CRITICAL( &mux );
+
   this->minEncoderValue = minValue;
 
+  addToValue( 0 );  // Bring the current value into the new range
+
   portEXIT_CRITICAL( &mux );
 }
 
 void RotaryEncoder::setMaxValue( long maxValue )
 {
-  portENTER_CRITICAL( &mux );
-
   ESP_LOGD( LOG_TAG, "maxValue = %ld", maxValue );
 
+  portENTER_CRITICAL( &mux );
+
   this->maxEncoderValue = maxValue;
 
+  addToValue( 0 );  // Bring the current value into the new range
+
   portEXIT_CRITICAL( &mux );
 }
 
 void RotaryEncoder::setCircular( bool circleValues )
 {
-  portENTER_CRITICAL( &mux );
-
   ESP_LOGD( LOG_TAG, "Boundaries %s circular", ( circleValues ? "are" : "are not" ) );
 
+  portENTER_CRITICAL( &mux );
+
   this->circleValues = circleValues;
 
+  addToValue( 0 );  // Bring the current value into the new range
+
   portEXIT_CRITICAL( &mux );
 }
 
 void RotaryEncoder::setStepValue( long stepValue )
 {
-  portENTER_CRITICAL( &mux );
-
   ESP_LOGD( LOG_TAG, "stepValue = %ld", stepValue );
 
   if( stepValue > maxEncoderValue || stepValue < minEncoderValue )
     ESP_LOGW( LOG_TAG, "Step value (%ld) is outside the bounds (%ld...%ld); behavior is undefined.", stepValue, minEncoderValue, maxEncoderValue );
 
+  portENTER_CRITICAL( &mux );
+
   this->stepValue = stepValue;
 
+  buildAccelerationTable();
+
   portEXIT_CRITICAL( &mux );
 }
 
-void RotaryEncoder::onTurned( EncoderCallback f )
+void RotaryEncoder::setAcceleration( AccelerationProfile profile, uint16_t maxMultiplier )
 {
-  callbackEncoderChanged = f;
+  if( profile > ACCEL_EXPONENTIAL )
+  {
+    ESP_LOGE( LOG_TAG, "Invalid acceleration profile %i", profile );
+    return;
+  }
+
+  if( maxMultiplier < 1 )
+    maxMultiplier = 1;
+
+  ESP_LOGD( LOG_TAG, "Acceleration profile %i, up to %ux", profile, maxMultiplier );
+
+  portENTER_CRITICAL( &mux );
+
+  this->accelerationProfile = profile;
+
+  for( size_t i = 0; i < RE_ACCEL_BUCKETS; i++ )
+  {
+    // 0 for the fastest bucket, 1 for the slowest
+    float slowness = (float)i / ( RE_ACCEL_BUCKETS - 1 );
+
+    switch( profile )
+    {
+      case ACCEL_LINEAR:
+        accelerationMultipliers[i] = (uint16_t)( maxMultiplier - ( maxMultiplier - 1 ) * slowness + 0.5f );
+      break;
+
+      case ACCEL_EXPONENTIAL:
+        accelerationMultipliers[i] = (uint16_t)( powf( maxMultiplier, 1.0f - slowness ) + 0.5f );
+      break;
+
+      default:
+        // ACCEL_DEFAULT depends on the step value, so it's worked out in `buildAccelerationTable()`
+        accelerationMultipliers[i] = 1;
+      break;
+    }
+  }
+
+  buildAccelerationTable();
+
+  portEXIT_CRITICAL( &mux );
 }
 
-void RotaryEncoder::onPressed( ButtonCallback f )
+void RotaryEncoder::setAccelerationTable( const uint16_t *multipliers, size_t count )
 {
-  callbackButtonPressed = f;
+  if( count > RE_ACCEL_BUCKETS )
+  {
+    ESP_LOGW( LOG_TAG, "Acceleration table has %u entries; only the first %i are used", (unsigned int)count, RE_ACCEL_BUCKETS );
+    count = RE_ACCEL_BUCKETS;
+  }
+
+  portENTER_CRITICAL( &mux );
+
+  this->accelerationProfile = ACCEL_CUSTOM;
+
+  for( size_t i = 0; i < RE_ACCEL_BUCKETS; i++ )
+    accelerationMultipliers[i] = ( i < count && multipliers[i] > 0 ) ? multipliers[i] : 1;
+
+  buildAccelerationTable();
+
+  portEXIT_CRITICAL( &mux );
 }
 
-void RotaryEncoder::beginLoopTimer()
+void RotaryEncoder::setAccelerationSmoothing( uint8_t detents )
 {
-  /**
-   * We're using esp_timer.h from ESP32 SDK rather than esp32-hal-timer.h from Arduino API
-   * because the `timerAttachInterrupt()` won't accept std::bind like `attachInterrupt()` in
-   * FunctionalInterrupt will.  We have a static method that `timerAttachInterrupt()` will take,
-   * but we'd lose instance context.  But the `esp_timer_create_args_t` will let us set a callback
-   * argument, which we set to `this`, so that the static method maintains instance context.
-   *
-   * As of 29 September 2023, there is an open issue to allow `std::function` in esp32-hal-timer:
-   * https://github.com/espressif/arduino-esp32/issues/8427
-   *
-   * ...for now (and maybe forever?), we'll do it this way.
-   */
+  uint8_t shift = 0;
 
-  esp_timer_create_args_t _timerConfig;
-  _timerConfig.arg = this;
-  _timerConfig.callback = reinterpret_cast<esp_timer_cb_t>( timerCallback );
-  _timerConfig.dispatch_method = ESP_TIMER_TASK;
-  _timerConfig.skip_unhandled_events = true;
-  _timerConfig.name = "RotaryEncoder::loop_ISR";
+  while( shift < 3 && ( 2 << shift ) <= detents )
+    shift++;
 
-  esp_timer_create( &_timerConfig, &loopTimer );
-  esp_timer_start_periodic( loopTimer, RE_LOOP_INTERVAL );
+  ESP_LOGD( LOG_TAG, "Acceleration averaged over %u detents", 1 << shift );
+
+  portENTER_CRITICAL( &mux );
+
+  this->accelerationSmoothing = shift;
+
+  resetIntervals();
+
+  portEXIT_CRITICAL( &mux );
 }
 
-void RotaryEncoder::attachInterrupts()
+void RotaryEncoder::buildAccelerationTable()
 {
-  #if defined( BOARD_HAS_PIN_REMAP ) && ( ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3,0,0) )
-    /**
-     * The io_pin_remap.h in Arduino-ESP32 cores of the 2.0.x family
-     * (since 2.0.10) define an `attachInterrupt()` macro that folds-in
-     * a call to `digitalPinToGPIONumber()`, but FunctionalInterrupt.cpp
-     * does this too, so we actually don't need the macro at all.
-     * Since 3.x the call inside the function was removed, so the wrapping
-     * macro is useful again.
-     */
-    #undef attachInterrupt
-  #endif
+  for( size_t i = 0; i < RE_ACCEL_BUCKETS; i++ )
+  {
+    long multiplier = accelerationMultipliers[i];
 
-  attachInterrupt( encoderPinA, std::bind( &RotaryEncoder::_encoder_ISR, this ), CHANGE );
-  attachInterrupt( encoderPinB, std::bind( &RotaryEncoder::_encoder_ISR, this ), CHANGE );
+    if( accelerationProfile == ACCEL_DEFAULT )
+    {
+      uint32_t interval = (uint32_t)i << RE_ACCEL_SHIFT;
 
-  if( encoderPinButton > RE_DEFAULT_PIN )
-    attachInterrupt( encoderPinButton, std::bind( &RotaryEncoder::_button_ISR, this ), CHANGE );
+      if( interval >= 40000UL )                    // 40 milliseconds or slower
+        multiplier = 1;                            // Increase/decrease by 1 x stepValue
 
-  ESP_LOGD( LOG_TAG, "Interrupts attached" );
+      else if( interval >= 20000UL )               // 20 milliseconds or slower
+        multiplier = ( stepValue <= 9 ) ? 1 : 3;   // 3 x stepValue, but only if stepValue > 9
+
+      else                                         // Faster than 20 milliseconds
+        multiplier = ( stepValue <= 100 ) ? 1 : 10;// 10 x stepValue, but only if stepValue > 100
+    }
+
+    else if( accelerationProfile == ACCEL_NONE )
+      multiplier = 1;
+
+    accelerationSteps[i] = stepValue * multiplier;
+  }
 }
 
-void RotaryEncoder::detachInterrupts()
+void RotaryEncoder::resetIntervals()
 {
-  detachInterrupt( encoderPinA );
-  detachInterrupt( encoderPinB );
-  detachInterrupt( encoderPinButton );
+  uint8_t count = 1 << accelerationSmoothing;
 
-  ESP_LOGD( LOG_TAG, "Interrupts detached" );
+  for( uint8_t i = 0; i < RE_ACCEL_SMOOTHING_MAX; i++ )
+    isrState.intervals[i] = RE_ACCEL_MAX_INTERVAL;
+
+  isrState.intervalIndex = 0;
+  isrState.intervalSum = RE_ACCEL_MAX_INTERVAL * count;
 }
 
-void RotaryEncoder::begin( bool useTimer )
+void RotaryEncoder::setFastRead( bool fastRead )
 {
-  resetEncoderValue();
+  ESP_LOGD( LOG_TAG, "Fast read %s", ( fastRead ? "requested" : "disabled" ) );
 
-  encoderChangedFlag = false;
-  buttonPressedFlag = false;
-  buttonPressedTime = 0;
-  buttonPressedDuration = 0;
+  this->fastRead = fastRead;
+}
 
-  pinMode( encoderPinA, encoderPinMode );
-  pinMode( encoderPinB, encoderPinMode );
+void RotaryEncoder::setGlitchFilter( uint32_t microseconds )
+{
+  ESP_LOGD( LOG_TAG, "Glitch filter %lu us", (unsigned long)microseconds );
 
-  if( encoderPinButton > RE_DEFAULT_PIN )
-    pinMode( encoderPinButton, buttonPinMode );
+  portENTER_CRITICAL( &mux );
 
-  if( encoderPinVcc > RE_DEFAULT_PIN )
+  this->glitchFilter = microseconds;
+
+  portEXIT_CRITICAL( &mux );
+}
+
+void RotaryEncoder::setDecodeMode( DecodeMode mode )
+{
+  switch( mode )
   {
-    pinMode( encoderPinVcc, OUTPUT );
-    digitalWrite( encoderPinVcc, HIGH );
+    case DECODE_X1:
+    case DECODE_X2:
+    case DECODE_X4:
+    break;
+
+    default:
+      ESP_LOGE( LOG_TAG, "Invalid decode mode %i", mode );
+      return;
   }
 
-  delay( 20 );
-  attachInterrupts();
+  // E.g. X1 sees one edge per quadrature cycle, which is two detents of a 2-step encoder
+  if( ( ( encoderTripPoint + 1 ) * mode ) % DECODE_X4 != 0 )
+  {
+    ESP_LOGE( LOG_TAG, "X%i can't count single detents of %i steps; keeping X%i", mode, encoderTripPoint + 1, decodeMode );
+    return;
+  }
 
-  if( useTimer )
-    beginLoopTimer();
+  this->decodeMode = mode;
 
-  ESP_LOGD( LOG_TAG, "RotaryEncoder active" );
+  ESP_LOGD( LOG_TAG, "Decode mode set to X%i", mode );
 }
 
-bool RotaryEncoder::isEnabled()
+void RotaryEncoder::setDispatchMode( DispatchMode mode )
 {
-  return _isEnabled;
-}
+  switch( mode )
+  {
+    case DISPATCH_TIMER:
+    case DISPATCH_NOTIFY:
+      this->dispatchMode = mode;
+    break;
 
-void RotaryEncoder::enable()
-{
-  if( _isEnabled )
-    return;
+    default:
+      ESP_LOGE( LOG_TAG, "Invalid dispatch mode %i", mode );
+      return;
+  }
 
-  attachInterrupts();
+  ESP_LOGD( LOG_TAG, "Dispatch mode set to %i", mode );
+}
 
-  _isEnabled = true;
+void RotaryEncoder::setCoalesceWindow( uint32_t milliseconds )
+{
+  ESP_LOGD( LOG_TAG, "Coalesce window = %lu ms", (unsigned long)milliseconds );
 
-  ESP_LOGD( LOG_TAG, "Input enabled" );
+  this->coalesceWindow = milliseconds;
 }
 
-void RotaryEncoder::disable()
+void RotaryEncoder::setLowPower( uint32_t idleMs, bool switchVcc )
 {
-  if( !_isEnabled )
-    return;
+  // Activity is timed in microseconds, which wrap around after about 71 minutes
+  if( idleMs > 3600000 )
+  {
+    ESP_LOGW( LOG_TAG, "Idle timeout %lu ms is too long; using 3600000 ms", (unsigned long)idleMs );
+    idleMs = 3600000;
+  }
 
-  detachInterrupts();
+  if( switchVcc && encoderPinVcc <= RE_DEFAULT_PIN )
+  {
+    ESP_LOGW( LOG_TAG, "No Vcc pin was given, so it can't be switched off while idle" );
+    switchVcc = false;
+  }
 
-  _isEnabled = false;
+  ESP_LOGD( LOG_TAG, "Low power: idle after %lu ms%s", (unsigned long)idleMs, ( switchVcc ? ", switching Vcc" : "" ) );
 
-  ESP_LOGD( LOG_TAG, "Input disabled" );
+  this->idleTimeout = idleMs;
+  this->idleSwitchVcc = switchVcc;
 }
 
-bool RotaryEncoder::buttonPressed()
+bool RotaryEncoder::isIdle()
 {
-  portENTER_CRITICAL( &mux );
-
-  if( !_isEnabled )
-    return false;
+  return lowPowerIdle;
+}
 
-  if( buttonPressedFlag )
-    ESP_LOGD( LOG_TAG, "Button pressed for %lu ms", buttonPressedDuration );
+void RotaryEncoder::onTurned( EncoderCallback f )
+{
+  callbackEncoderChanged = f;
+}
 
-  bool wasPressed = buttonPressedFlag;
+void RotaryEncoder::onTurnedDetailed( TurnCallback f )
+{
+  callbackTurnDetailed = f;
+}
 
-  buttonPressedFlag = false;
+void RotaryEncoder::setTurnedPolicy( uint32_t minIntervalMs, long minDelta, uint32_t settleMs, bool leading, bool trailing )
+{
+  if( !leading && !trailing )
+  {
+    ESP_LOGW( LOG_TAG, "A rate limit needs a leading or trailing call; using leading" );
+    leading = true;
+  }
 
-  portEXIT_CRITICAL( &mux );
+  ESP_LOGD( LOG_TAG, "Turned policy: every %lu ms, delta %ld, settle %lu ms, %s%s", (unsigned long)minIntervalMs, minDelta, (unsigned long)settleMs,
+    ( leading ? "leading" : "" ), ( trailing ? ( leading ? "+trailing" : "trailing" ) : "" ) );
 
-  return wasPressed;
+  this->turnMinInterval = minIntervalMs;
+  this->turnMinDelta = minDelta;
+  this->turnSettleTime = settleMs;
+  this->turnLeading = leading;
+  this->turnTrailing = trailing;
+  this->turnWindowOpen = false;
 }
 
-bool RotaryEncoder::encoderChanged()
+bool RotaryEncoder::turnDue( uint32_t now, long value )
 {
-  portENTER_CRITICAL( &mux );
+  // Held back (not dropped) until it's gone far enough
+  if( turnMinDelta > 1 && labs( value - reportedValue ) < turnMinDelta )
+    return false;
 
-  if( !_isEnabled )
+  if( turnSettleTime > 0 && now - lastTurnTime < turnSettleTime )
     return false;
 
-  if( encoderChangedFlag )
-    ESP_LOGD( LOG_TAG, "Knob turned; value: %ld", getEncoderValue() );
+  if( turnMinInterval == 0 )
+    return true;
+
+  if( turnWindowOpen && now - turnWindowStart < turnMinInterval )
+  {
+    // Leading only: whatever happens during the interval is dropped
+    if( !turnTrailing )
+      turnPending = false;
 
-  bool hasChanged = encoderChangedFlag;
+    return false;
+  }
 
-  encoderChangedFlag = false;
+  // Either the interval ran out with a change held back (the trailing call), or this
+  // is the first change of a burst, which only gets a call right away if leading
+  bool trailingCall = turnWindowOpen;
 
-  portEXIT_CRITICAL( &mux );
+  turnWindowOpen = true;
+  turnWindowStart = now;
 
-  return hasChanged;
+  return trailingCall || turnLeading;
 }
 
-long RotaryEncoder::getEncoderValue()
+uint32_t RotaryEncoder::turnWait( uint32_t now )
 {
-  portENTER_CRITICAL( &mux );
-
-  constrainValue();
+  uint32_t wait = 0;
 
-  long value = currentValue;
+  if( turnSettleTime > 0 && now - lastTurnTime < turnSettleTime )
+    wait = turnSettleTime - ( now - lastTurnTime );
 
-  portEXIT_CRITICAL( &mux );
+  if( turnWindowOpen && now - turnWindowStart < turnMinInterval && turnMinInterval - ( now - turnWindowStart ) > wait )
+    wait = turnMinInterval - ( now - turnWindowStart );
 
-  return value;
+  return wait;
 }
 
-void RotaryEncoder::constrainValue()
+TickType_t RotaryEncoder::dispatchWait()
 {
-  long unconstrainedValue = currentValue;
+  if( turnPending )
+  {
+    uint32_t wait = turnWait( millis() );
 
-  if( currentValue < minEncoderValue )
-    currentValue = circleValues ? maxEncoderValue : minEncoderValue;
+    if( wait > 0 )
+      return pdMS_TO_TICKS( wait ) + 1;
 
-  else if( currentValue > maxEncoderValue )
-    currentValue = circleValues ? minEncoderValue : maxEncoderValue;
+    // Unless it's held back by `minDelta` alone, which only another turn can change
+    if( turnMinDelta <= 1 || labs( getEncoderValue() - reportedValue ) >= turnMinDelta )
+      return 1;
+  }
+
+  // Wake up once more to go idle, when nothing has happened for long enough
+  if( idleTimeout > 0 && !lowPowerIdle && backend == ISR_BACKEND )
+    return pdMS_TO_TICKS( idleRemaining() ) + 1;
 
-  if( unconstrainedValue != currentValue )
-    ESP_LOGD( LOG_TAG, "Encoder value '%ld' constrained to '%ld'", unconstrainedValue, currentValue );
+  return portMAX_DELAY;
 }
 
-void RotaryEncoder::setEncoderValue( long newValue )
+void RotaryEncoder::onPressed( ButtonCallback f )
 {
-  portENTER_CRITICAL( &mux );
+  callbackButtonPressed = f;
+}
 
-  if( newValue != currentValue )
-    ESP_LOGD( LOG_TAG, "Overriding encoder value from '%ld' to '%ld'", currentValue, newValue );
+void RotaryEncoder::setButtonDebounce( uint32_t microseconds, DebounceMode mode )
+{
+  ESP_LOGD( LOG_TAG, "Button debounce %lu us, %s", (unsigned long)microseconds, ( mode == DEBOUNCE_INTEGRATING ? "integrating" : "lockout" ) );
 
-  currentValue = newValue;
+  portENTER_CRITICAL( &mux );
 
-  constrainValue();
+  this->debounceTime = microseconds;
+  this->debounceMode = mode;
 
   portEXIT_CRITICAL( &mux );
 }
 
-void ARDUINO_ISR_ATTR RotaryEncoder::loop()
+void RotaryEncoder::onButtonGesture( GestureCallback f )
 {
-  if( callbackEncoderChanged != NULL && encoderChanged() )
-    callbackEncoderChanged( getEncoderValue() );
+  callbackGesture = f;
+
+  if( gestureTimer != NULL )
+    return;
+
+  esp_timer_create_args_t _timerConfig;
+  _timerConfig.arg = this;
+  _timerConfig.callback = gestureTimerCallback;
+  _timerConfig.dispatch_method = ESP_TIMER_TASK;
+  _timerConfig.skip_unhandled_events = true;
+  _timerConfig.name = "RotaryEncoder::gesture";
+
+  esp_timer_handle_t timer;
+
+  if( esp_timer_create( &_timerConfig, &timer ) != ESP_OK )
+  {
+    ESP_LOGE( LOG_TAG, "Could not create the gesture timer" );
+    return;
+  }
 
-  if( callbackButtonPressed != NULL && buttonPressed() )
-    callbackButtonPressed( buttonPressedDuration );
+  portENTER_CRITICAL( &mux );
+  gestureTimer = timer;
+  portEXIT_CRITICAL( &mux );
 }
 
-void ARDUINO_ISR_ATTR RotaryEncoder::_button_ISR()
+void RotaryEncoder::setGestureTiming( uint32_t longPressMs, uint32_t doubleClickMs, uint32_t repeatMs )
 {
-  portENTER_CRITICAL_ISR( &mux );
+  ESP_LOGD( LOG_TAG, "Gestures: long press %lu ms, double-click %lu ms, repeat %lu ms", (unsigned long)longPressMs, (unsigned long)doubleClickMs, (unsigned long)repeatMs );
 
-  static unsigned long _lastInterruptTime = 0;
+  portENTER_CRITICAL( &mux );
 
-  // Simple software de-bounce
-  if( ( millis() - _lastInterruptTime ) < 30 )
-    return;
+  this->longPressTime = longPressMs * 1000UL;
+  this->doubleClickTime = doubleClickMs * 1000UL;
+  this->repeatTime = repeatMs * 1000UL;
 
-  // HIGH = idle, LOW = active
-  bool isPressed = !digitalRead( encoderPinButton );
+  portEXIT_CRITICAL( &mux );
+}
 
+void ARDUINO_ISR_ATTR RotaryEncoder::gestureEdge( bool isPressed, int64_t now )
+{
   if( isPressed )
   {
-    buttonPressedTime = millis();
-
-    ESP_EARLY_LOGV( LOG_TAG, "Button pressed at %u", buttonPressedTime );
+    if( gestureState == GESTURE_RELEASED )
+    {
+      gestureState = GESTURE_SECOND_PRESS;
+      gestureDeadline = 0;
+    }
+    else
+    {
+      gestureState = GESTURE_PRESSED;
+      gestureDeadline = longPressTime ? now + longPressTime : 0;
+    }
   }
   else
   {
-    unsigned long now = millis();
-    buttonPressedDuration = now - buttonPressedTime;
-
-    ESP_EARLY_LOGV( LOG_TAG, "Button released at %u", now );
-
-    buttonPressedFlag = true;
+    switch( gestureState )
+    {
+      case GESTURE_PRESSED:
+        if( doubleClickTime )
+        {
+          gestureState = GESTURE_RELEASED;
+          gestureDeadline = now + doubleClickTime;
+          break;
+        }
+
+        gesturesPending |= 1 << BUTTON_CLICK;
+        gestureState = GESTURE_IDLE;
+        gestureDeadline = 0;
+      break;
+
+      case GESTURE_SECOND_PRESS:
+        gesturesPending |= 1 << BUTTON_DOUBLE_CLICK;
+        gestureState = GESTURE_IDLE;
+        gestureDeadline = 0;
+      break;
+
+      default:
+        // Released after a long press (already reported), or a release we never saw the press of
+        gestureState = GESTURE_IDLE;
+        gestureDeadline = 0;
+      break;
+    }
   }
 
-  _lastInterruptTime = millis();
-
-  portEXIT_CRITICAL_ISR( &mux );
+  armGestureTimer( now );
 }
 
-void ARDUINO_ISR_ATTR RotaryEncoder::_encoder_ISR()
+void ARDUINO_ISR_ATTR RotaryEncoder::armGestureTimer( int64_t now )
 {
-  portENTER_CRITICAL_ISR( &mux );
+  esp_timer_stop( gestureTimer );
 
-  /**
-   * Almost all of this came from a blog post by Garry on GarrysBlog.com:
-   * https://garrysblog.com/2021/03/20/reliably-debouncing-rotary-encoders-with-arduino-and-esp32/
-   *
-   * Read more about how this works here:
-   * https://www.best-microcontroller-projects.com/rotary-encoder.html
-   */
+  if( gesturesPending )
+    esp_timer_start_once( gestureTimer, 0 );
 
-  static uint8_t _previousAB = 3;
-  static int8_t _encoderPosition = 0;
-  static unsigned long _lastInterruptTime = 0;
-  static long _stepValue;
+  else if( gestureDeadline )
+    esp_timer_start_once( gestureTimer, ( gestureDeadline > now ) ? gestureDeadline - now : 0 );
+}
 
-  bool valueChanged = false;
+void RotaryEncoder::gestureTimerCallback( void *arg )
+{
+  RotaryEncoder *instance = (RotaryEncoder *)arg;
 
-  _previousAB <<=2;  // Remember previous state
+  portENTER_CRITICAL( &instance->mux );
 
-  if( digitalRead( encoderPinA ) ) _previousAB |= 0x02; // Add current state of pin A
-  if( digitalRead( encoderPinB ) ) _previousAB |= 0x01; // Add current state of pin B
+  int64_t now = esp_timer_get_time();
 
-  _encoderPosition += encoderStates[( _previousAB & 0x0f )];
+  if( instance->gestureDeadline && now >= instance->gestureDeadline )
+  {
+    switch( instance->gestureState )
+    {
+      case GESTURE_PRESSED:
+        instance->gesturesPending |= 1 << BUTTON_LONG_PRESS;
+        instance->gestureState = GESTURE_HELD;
+        instance->gestureDeadline = instance->repeatTime ? now + instance->repeatTime : 0;
+      break;
+
+      case GESTURE_HELD:
+        instance->gesturesPending |= 1 << BUTTON_REPEAT;
+        instance->gestureDeadline = now + instance->repeatTime;
+      break;
+
+      case GESTURE_RELEASED:
+        instance->gesturesPending |= 1 << BUTTON_CLICK;
+        instance->gestureState = GESTURE_IDLE;
+        instance->gestureDeadline = 0;
+      break;
+
+      default:
+        instance->gestureDeadline = 0;
+      break;
+    }
+  }
 
+  uint8_t pending = instance->gesturesPending;
+  instance->gesturesPending = 0;
 
-  /**
-   * Based on how fast the encoder is being turned, we can apply an acceleration factor
-   */
+  instance->armGestureTimer( now );
 
-  unsigned long speed = micros() - _lastInterruptTime;
+  portEXIT_CRITICAL( &instance->mux );
 
-  if( speed > 40000UL )                            // Greater than 40 milliseconds
-    _stepValue = this->stepValue;                  // Increase/decrease by 1 x stepValue
+  if( !instance->callbackGesture )
+    return;
 
-  else if( speed > 20000UL )                       // Greater than 20 milliseconds
-    _stepValue = ( this->stepValue <= 9 ) ?        // Increase/decrease by 3 x stepValue
-      this->stepValue : ( this->stepValue * 3 )    // But only if stepValue > 9
-    ;
+  for( uint8_t gesture = BUTTON_CLICK; gesture <= BUTTON_REPEAT; gesture++ )
+    if( pending & ( 1 << gesture ) )
+      instance->callbackGesture( (ButtonGesture)gesture );
+}
 
-  else                                             // Faster than 20 milliseconds
-    _stepValue = ( this->stepValue <= 100 ) ?      // Increase/decrease by 10 x stepValue
-      this->stepValue : ( this->stepValue * 10 )   // But only if stepValue > 100
-    ;
+void RotaryEncoder::setEventQueue( bool enabled )
+{
+  portENTER_CRITICAL( &mux );
+
+  ESP_LOGD( LOG_TAG, "Event queue %s", ( enabled ? "enabled" : "disabled" ) );
+
+  eventQueueEnabled = enabled;
+  eventTail.store( eventHead.load() );
+  eventOverflows = 0;
+
+  portEXIT_CRITICAL( &mux );
+}
+
+void RotaryEncoder::onEvent( EventCallback f )
+{
+  callbackEvent = f;
+}
+
+size_t RotaryEncoder::drainEvents( EncoderEvent *events, size_t maxEvents )
+{
+  uint32_t tail = eventTail.load( std::memory_order_relaxed );
+  uint32_t head = eventHead.load( std::memory_order_acquire );
+
+  size_t count = 0;
+
+  while( tail != head && count < maxEvents )
+    events[count++] = eventQueue[tail++ & ( RE_EVENT_QUEUE_SIZE - 1 )];
+
+  eventTail.store( tail, std::memory_order_release );
+
+  return count;
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::pushEvent( EncoderEventType type, long value, uint32_t timestamp )
+{
+  uint32_t head = eventHead.load( std::memory_order_relaxed );
+
+  if( head - eventTail.load( std::memory_order_acquire ) >= RE_EVENT_QUEUE_SIZE )
+  {
+    eventOverflows++;
+    return;
+  }
+
+  EncoderEvent &event = eventQueue[head & ( RE_EVENT_QUEUE_SIZE - 1 )];
+  event.timestamp = timestamp;
+  event.value = value;
+  event.type = type;
+
+  eventHead.store( head + 1, std::memory_order_release );
+}
+
+void RotaryEncoder::startCapture( uint32_t *buffer, size_t size )
+{
+  if( buffer == NULL || size == 0 )
+  {
+    ESP_LOGE( LOG_TAG, "No room to capture into" );
+    return;
+  }
+
+  uint8_t button = ( encoderPinButton > RE_DEFAULT_PIN && !digitalRead( encoderPinButton ) ) ? 0 : RE_CAPTURE_BUTTON;
+
+  portENTER_CRITICAL( &mux );
+
+  captureBuffer = buffer;
+  captureSize = size;
+  captureCount = 0;
+  captureButton = button;
+
+  // Where the pins are to begin with, so a replay can start from the same place
+  recordCapture( micros(), readAB() | captureButton );
+
+  portEXIT_CRITICAL( &mux );
+
+  ESP_LOGD( LOG_TAG, "Capturing up to %u edges", (unsigned int)size );
+}
+
+size_t RotaryEncoder::stopCapture()
+{
+  portENTER_CRITICAL( &mux );
+
+  uint32_t *buffer = captureBuffer;
+  size_t size = captureSize;
+  uint32_t count = captureCount;
+
+  captureBuffer = NULL;
+
+  portEXIT_CRITICAL( &mux );
+
+  if( buffer == NULL )
+    return 0;
+
+  ESP_LOGD( LOG_TAG, "Captured %lu edges", (unsigned long)count );
+
+  if( count <= size )
+    return count;
+
+  // The ring went around; the oldest entry is the one that would have been overwritten next
+  std::rotate( buffer, buffer + ( count % size ), buffer + size );
+
+  return size;
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::recordCapture( unsigned long now, uint8_t pins )
+{
+  captureBuffer[captureCount % captureSize] = ( (uint32_t)now << RE_CAPTURE_TIME_SHIFT ) | pins;
+  captureCount++;
+}
+
+#if RE_ENABLE_STATS
+EncoderStats RotaryEncoder::getStats()
+{
+  portENTER_CRITICAL( &mux );
+  EncoderStats snapshot = stats;
+  portEXIT_CRITICAL( &mux );
+
+  return snapshot;
+}
+
+void RotaryEncoder::resetStats()
+{
+  portENTER_CRITICAL( &mux );
+
+  stats = EncoderStats();
+  statsPendingDetents = 0;
+
+  portEXIT_CRITICAL( &mux );
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::recordSample( EncoderHistogram &histogram, uint32_t value )
+{
+  // Index of the highest bit set, so each bucket covers twice the range of the one before
+  uint32_t bucket = 31 - __builtin_clz( value | 1 );
+
+  histogram.buckets[( bucket < RE_STATS_BUCKETS ) ? bucket : RE_STATS_BUCKETS - 1]++;
+
+  if( histogram.count == 0 || value < histogram.min )
+    histogram.min = value;
+
+  if( value > histogram.max )
+    histogram.max = value;
+
+  histogram.count++;
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::recordDetents( uint32_t detents, unsigned long now )
+{
+  if( statsPendingDetents == 0 )
+    statsFirstDetent = now;
+
+  statsPendingDetents += detents;
+  stats.detents += detents;
+}
+
+void RotaryEncoder::recordReport()
+{
+  portENTER_CRITICAL( &mux );
+
+  stats.reports++;
+
+  if( statsPendingDetents > 0 )
+  {
+    stats.coalesced += statsPendingDetents - 1;
+    recordSample( stats.latency, micros() - statsFirstDetent );
+    statsPendingDetents = 0;
+  }
+
+  portEXIT_CRITICAL( &mux );
+}
+#endif
+
+bool RotaryEncoder::beginCounter()
+{
+  #if defined( RE_HAS_PCNT )
+    #if defined( BOARD_HAS_PIN_REMAP )
+      int gpioA = digitalPinToGPIONumber( encoderPinA );
+      int gpioB = digitalPinToGPIONumber( encoderPinB );
+    #else
+      int gpioA = encoderPinA;
+      int gpioB = encoderPinB;
+    #endif
+
+    /**
+     * The counter limits only need to be wide enough that the count can't
+     * wrap between two polls; with `accum_count` the driver extends the
+     * count in software when a limit is crossed, so nothing is lost anyway.
+     */
+    pcnt_unit_config_t unitConfig = {};
+    unitConfig.low_limit = -16384;
+    unitConfig.high_limit = 16384;
+    unitConfig.flags.accum_count = 1;
+
+    pcnt_glitch_filter_config_t filterConfig = {};
+    filterConfig.max_glitch_ns = RE_PCNT_GLITCH_NS;
+
+    pcnt_chan_config_t channelConfigA = {};
+    channelConfigA.edge_gpio_num = gpioA;
+    channelConfigA.level_gpio_num = gpioB;
+
+    pcnt_chan_config_t channelConfigB = {};
+    channelConfigB.edge_gpio_num = gpioB;
+    channelConfigB.level_gpio_num = gpioA;
+
+    esp_err_t err = pcnt_new_unit( &unitConfig, &counterUnit );
+
+    if( err == ESP_OK ) err = pcnt_unit_set_glitch_filter( counterUnit, &filterConfig );
+    if( err == ESP_OK ) err = pcnt_unit_add_watch_point( counterUnit, unitConfig.low_limit );
+    if( err == ESP_OK ) err = pcnt_unit_add_watch_point( counterUnit, unitConfig.high_limit );
+    if( err == ESP_OK ) err = pcnt_new_channel( counterUnit, &channelConfigA, &counterChannelA );
+
+    /**
+     * Turning right, A changes while B is the opposite level of A's new level
+     * (see the sequence in `encoderStates`), so, relative to B being HIGH:
+     * A falling counts up and A rising counts down; for B it's the reverse.
+     * A LOW level on the other pin inverts the direction.
+     *
+     * X4 uses both edges of both pins, X2 uses both edges of A only, and
+     * X1 uses only the falling edge of A.
+     */
+    if( err == ESP_OK ) err = pcnt_channel_set_edge_action( counterChannelA,
+      ( decodeMode == DECODE_X1 ) ? PCNT_CHANNEL_EDGE_ACTION_HOLD : PCNT_CHANNEL_EDGE_ACTION_DECREASE,
+      PCNT_CHANNEL_EDGE_ACTION_INCREASE
+    );
+    if( err == ESP_OK ) err = pcnt_channel_set_level_action( counterChannelA, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE );
+
+    if( decodeMode == DECODE_X4 )
+    {
+      if( err == ESP_OK ) err = pcnt_new_channel( counterUnit, &channelConfigB, &counterChannelB );
+      if( err == ESP_OK ) err = pcnt_channel_set_edge_action( counterChannelB, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE );
+      if( err == ESP_OK ) err = pcnt_channel_set_level_action( counterChannelB, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE );
+    }
+
+    if( err == ESP_OK ) err = pcnt_unit_enable( counterUnit );
+    if( err == ESP_OK ) err = pcnt_unit_clear_count( counterUnit );
+    if( err == ESP_OK ) err = pcnt_unit_start( counterUnit );
+
+    if( err != ESP_OK )
+    {
+      ESP_LOGE( LOG_TAG, "Could not set up pulse counter (error 0x%x)", err );
+      endCounter();
+      return false;
+    }
+
+    counterLast = 0;
+    counterRemainder = 0;
+
+    ESP_LOGD( LOG_TAG, "Pulse counter started: X%i, glitch filter %u ns", decodeMode, RE_PCNT_GLITCH_NS );
+
+    return true;
+  #else
+    ESP_LOGE( LOG_TAG, "Pulse counter is not supported on this chip or core" );
+
+    return false;
+  #endif
+}
+
+void RotaryEncoder::endCounter()
+{
+  #if defined( RE_HAS_PCNT )
+    if( counterUnit == NULL )
+      return;
+
+    pcnt_unit_stop( counterUnit );
+    pcnt_unit_disable( counterUnit );
+
+    if( counterChannelA != NULL )
+      pcnt_del_channel( counterChannelA );
+
+    if( counterChannelB != NULL )
+      pcnt_del_channel( counterChannelB );
+
+    pcnt_del_unit( counterUnit );
+
+    counterUnit = NULL;
+    counterChannelA = NULL;
+    counterChannelB = NULL;
+  #endif
+}
+
+void RotaryEncoder::pollCounter()
+{
+  #if defined( RE_HAS_PCNT )
+    int count;
+
+    if( counterUnit == NULL || pcnt_unit_get_count( counterUnit, &count ) != ESP_OK )
+      return;
+
+    portENTER_CRITICAL( &mux );
+
+    // The accumulated count is an int too, and wraps; the difference is right across the wrap
+    int counted = (int)( (uint32_t)count - (uint32_t)counterLast );
+
+    counterRemainder += counted;
+
+    // Same trip point as the ISR backend
+    int countsPerDetent = decodeTripPoint + 1;
+
+    int detents = counterRemainder / countsPerDetent;
+
+    if( counted != 0 )
+      addToPosition( counted, micros(), abs( detents ) );
+
+    counterLast = count;
+
+    if( detents != 0 )
+    {
+      counterRemainder -= detents * countsPerDetent;
+
+      addToValue( detents * this->stepValue );
+      encoderChanges.fetch_add( 1, std::memory_order_release );
+
+      RE_STATS( recordDetents( abs( detents ), micros() ) );
+
+      if( eventQueueEnabled )
+      {
+        EncoderEventType type = ( detents > 0 ) ? TURNED_RIGHT : TURNED_LEFT;
+        long step = ( detents > 0 ) ? this->stepValue : -this->stepValue;
+        uint32_t now = micros();
+
+        for( int i = abs( detents ); i > 0; i-- )
+          pushEvent( type, step, now );
+      }
+    }
+
+    portEXIT_CRITICAL( &mux );
+  #endif
+}
+
+void RotaryEncoder::beginLoopTimer()
+{
+  /**
+   * We're using esp_timer.h from ESP32 SDK rather than esp32-hal-timer.h from Arduino API
+   * because the `timerAttachInterrupt()` won't accept std::bind like `attachInterrupt()` in
+   * FunctionalInterrupt will.  We have a static method that `timerAttachInterrupt()` will take,
+   * but we'd lose instance context.  But the `esp_timer_create_args_t` will let us set a callback
+   * argument, which we set to `this`, so that the static method maintains instance context.
+   *
+   * As of 29 September 2023, there is an open issue to allow `std::function` in esp32-hal-timer:
+   * https://github.com/espressif/arduino-esp32/issues/8427
+   *
+   * ...for now (and maybe forever?), we'll do it this way.
+   */
+
+  esp_timer_create_args_t _timerConfig;
+  _timerConfig.arg = this;
+  _timerConfig.callback = reinterpret_cast<esp_timer_cb_t>( timerCallback );
+  _timerConfig.dispatch_method = ESP_TIMER_TASK;
+  _timerConfig.skip_unhandled_events = true;
+  _timerConfig.name = "RotaryEncoder::loop_ISR";
+
+  esp_timer_create( &_timerConfig, &loopTimer );
+  esp_timer_start_periodic( loopTimer, RE_LOOP_INTERVAL );
+}
+
+int8_t RotaryEncoder::gpioNumber( uint8_t pin )
+{
+  #if defined( BOARD_HAS_PIN_REMAP )
+    return digitalPinToGPIONumber( pin );
+  #else
+    return pin;
+  #endif
+}
+
+void RotaryEncoder::configureFastRead()
+{
+  int8_t gpioA = gpioNumber( encoderPinA );
+  int8_t gpioB = gpioNumber( encoderPinB );
+
+  uint8_t bank = gpioA / 32;
+
+  if( gpioA < 0 || gpioB < 0 || bank != gpioB / 32 )
+  {
+    ESP_LOGW( LOG_TAG, "Pins A (GPIO %i) and B (GPIO %i) are not in the same GPIO bank; fast read disabled", gpioA, gpioB );
+    fastRead = false;
+    return;
+  }
+
+  #if SOC_GPIO_PIN_COUNT > 32
+    gpioInputRegister = bank ? GPIO_IN1_REG : GPIO_IN_REG;
+  #else
+    gpioInputRegister = GPIO_IN_REG;
+  #endif
+
+  gpioShiftA = gpioA % 32;
+  gpioShiftB = gpioB % 32;
+
+  ESP_LOGD( LOG_TAG, "Fast read enabled: bank %u, A = bit %u, B = bit %u", bank, gpioShiftA, gpioShiftB );
+}
+
+void RotaryEncoder::beginDispatchTask()
+{
+  if( xTaskCreate( dispatchTaskFunction, "RotaryEncoder", RE_DISPATCH_STACK_SIZE, this, RE_DISPATCH_PRIORITY, &dispatchTask ) != pdPASS )
+  {
+    ESP_LOGE( LOG_TAG, "Could not create dispatcher task; falling back to the loop timer" );
+    dispatchTask = NULL;
+    beginLoopTimer();
+    return;
+  }
+
+  dispatchTaskOwned = true;
+}
+
+void RotaryEncoder::dispatchTaskFunction( void *arg )
+{
+  RotaryEncoder *instance = (RotaryEncoder *)arg;
+
+  for( ;; )
+  {
+    // Asleep until an ISR has news, or until a change held back by the policy comes due
+    ulTaskNotifyTake( pdTRUE, instance->dispatchWait() );
+
+    uint32_t window = instance->coalesceWindow;
+
+    if( window > 0 )
+    {
+      vTaskDelay( pdMS_TO_TICKS( window ) );
+
+      // Whatever happened during the window is handled by this `loop()` as well
+      ulTaskNotifyTake( pdTRUE, 0 );
+    }
+
+    instance->loop();
+  }
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::notifyDispatcher()
+{
+  if( dispatchTask == NULL )
+    return;
+
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+  vTaskNotifyGiveFromISR( dispatchTask, &higherPriorityTaskWoken );
+
+  if( higherPriorityTaskWoken )
+    portYIELD_FROM_ISR();
+}
+
+uint32_t RotaryEncoder::idleRemaining()
+{
+  // Still to be reported once the policy's time comes, or the button is being held; that's
+  // not idle.  A change held back by `minDelta` alone waits for another turn, which wakes us.
+  if( ( turnPending && turnWait( millis() ) > 0 ) || isrState.buttonDown )
+    return idleTimeout;
+
+  uint32_t now = micros();
+  uint32_t quiet = now - readPosition().time;
+  uint32_t sinceButton = now - (uint32_t)isrState.lastButtonTime;
+
+  if( encoderPinButton > RE_DEFAULT_PIN && sinceButton < quiet )
+    quiet = sinceButton;
+
+  quiet /= 1000;
+
+  return ( quiet < idleTimeout ) ? idleTimeout - quiet : 0;
+}
+
+void RotaryEncoder::enterIdle()
+{
+  // Nothing is touched unless it's quiet
+  if( idleRemaining() > 0 )
+    return;
+
+  if( loopTimer != NULL )
+    esp_timer_stop( loopTimer );
+
+  if( idleSwitchVcc )
+  {
+    // The internal pull-ups take over from the module's, so the knob can still wake the chip
+    pinMode( encoderPinA, INPUT_PULLUP );
+    pinMode( encoderPinB, INPUT_PULLUP );
+
+    if( encoderPinButton > RE_DEFAULT_PIN )
+      pinMode( encoderPinButton, INPUT_PULLUP );
+
+    pinMode( encoderPinVcc, INPUT );
+    vccReleased = true;
+  }
+
+  portENTER_CRITICAL( &mux );
+
+  // The knob may have moved while the timer was being stopped
+  bool busy = idleRemaining() > 0;
+
+  if( !busy )
+  {
+    // Along with the flag, so that the first level interrupt is sure to find it set
+    setWakeSources( true );
+    lowPowerIdle = true;
+
+    // Dropped rather than reported; the value it held back still counts towards `minDelta`
+    turnPending = false;
+  }
+
+  portEXIT_CRITICAL( &mux );
+
+  if( busy )
+  {
+    if( vccReleased )
+      restorePower();
+
+    if( loopTimer != NULL )
+      esp_timer_start_periodic( loopTimer, RE_LOOP_INTERVAL );
+
+    return;
+  }
+
+  esp_sleep_enable_gpio_wakeup();
+
+  ESP_LOGD( LOG_TAG, "Idle; waiting for the knob or button to wake up" );
+}
+
+void RotaryEncoder::restorePower()
+{
+  pinMode( encoderPinVcc, OUTPUT );
+  digitalWrite( encoderPinVcc, HIGH );
+
+  pinMode( encoderPinA, encoderPinMode );
+  pinMode( encoderPinB, encoderPinMode );
+
+  if( encoderPinButton > RE_DEFAULT_PIN )
+    pinMode( encoderPinButton, buttonPinMode );
+
+  vccReleased = false;
+}
+
+void RotaryEncoder::setWakeSources( bool enable )
+{
+  // The same pins and edges as `attachInterrupts()`
+  setWakeSource( encoderPinA, enable, ( decodeMode == DECODE_X1 ) ? GPIO_INTR_POSEDGE : GPIO_INTR_ANYEDGE );
+
+  if( decodeMode == DECODE_X4 )
+    setWakeSource( encoderPinB, enable, GPIO_INTR_ANYEDGE );
+
+  if( encoderPinButton > RE_DEFAULT_PIN )
+    setWakeSource( encoderPinButton, enable, GPIO_INTR_ANYEDGE );
+}
+
+void RotaryEncoder::setWakeSource( uint8_t pin, bool enable, gpio_int_type_t edges )
+{
+  gpio_num_t gpio = (gpio_num_t)gpioNumber( pin );
+
+  if( enable )
+  {
+    // Light sleep only wakes on a level; the one the pin isn't at means any change will do
+    gpio_wakeup_enable( gpio, digitalRead( pin ) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL );
+  }
+  else
+  {
+    gpio_wakeup_disable( gpio );
+    gpio_set_intr_type( gpio, edges );
+  }
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::setEdgeInterrupts()
+{
+  gpio_ll_set_intr_type( &GPIO, gpioNumber( encoderPinA ), ( decodeMode == DECODE_X1 ) ? GPIO_INTR_POSEDGE : GPIO_INTR_ANYEDGE );
+
+  if( decodeMode == DECODE_X4 )
+    gpio_ll_set_intr_type( &GPIO, gpioNumber( encoderPinB ), GPIO_INTR_ANYEDGE );
+
+  if( encoderPinButton > RE_DEFAULT_PIN )
+    gpio_ll_set_intr_type( &GPIO, gpioNumber( encoderPinButton ), GPIO_INTR_ANYEDGE );
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::wakeUp()
+{
+  portENTER_CRITICAL_ISR( &mux );
+
+  // Another pin's ISR may have got here first
+  bool woke = lowPowerIdle;
+
+  if( woke )
+  {
+    // A level interrupt left in place would fire again as soon as this returns, for as
+    // long as the level lasts, and keep the task that's to finish waking up from running
+    setEdgeInterrupts();
+
+    lowPowerIdle = false;
+    wakePending = true;
+  }
+
+  portEXIT_CRITICAL_ISR( &mux );
+
+  if( !woke )
+    return;
+
+  // Even without a detent, `loop()` has to run to power up and to go idle again later
+  if( dispatchTask != NULL )
+    notifyDispatcher();
+
+  // Nothing runs `loop()` until the loop timer is started again, which an ISR can't do
+  else if( loopTimer != NULL )
+  {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    xTimerPendFunctionCallFromISR( finishWakeUpCallback, this, 0, &higherPriorityTaskWoken );
+
+    if( higherPriorityTaskWoken )
+      portYIELD_FROM_ISR();
+  }
+}
+
+void RotaryEncoder::finishWakeUp()
+{
+  portENTER_CRITICAL( &mux );
+
+  bool pending = wakePending;
+  wakePending = false;
+
+  portEXIT_CRITICAL( &mux );
+
+  if( !pending )
+    return;
+
+  // `wakeUp()` already put the interrupt types back; this lets the driver know too
+  setWakeSources( false );
+
+  if( loopTimer != NULL )
+    esp_timer_start_periodic( loopTimer, RE_LOOP_INTERVAL );
+}
+
+void RotaryEncoder::finishWakeUpCallback( void *instance, uint32_t /* unused */ )
+{
+  static_cast<RotaryEncoder *>( instance )->finishWakeUp();
+}
+
+void RotaryEncoder::attachInterrupts()
+{
+  /**
+   * `attachInterruptArg()` takes a plain function and a `void *`, so the thunks below
+   * call straight into the ISR methods with `this`, without anything on the heap.
+   */
+  if( backend == ISR_BACKEND )
+  {
+    // X4 needs every edge of both pins; X2 only needs A's, and X1 only A rising
+    attachInterruptArg( encoderPinA, rotaryEncoderThunk<RotaryEncoder, &RotaryEncoder::_encoder_ISR>, this, ( decodeMode == DECODE_X1 ) ? RISING : CHANGE );
+
+    if( decodeMode == DECODE_X4 )
+      attachInterruptArg( encoderPinB, rotaryEncoderThunk<RotaryEncoder, &RotaryEncoder::_encoder_ISR>, this, CHANGE );
+  }
+
+  if( encoderPinButton > RE_DEFAULT_PIN )
+    attachInterruptArg( encoderPinButton, rotaryEncoderThunk<RotaryEncoder, &RotaryEncoder::_button_ISR>, this, CHANGE );
+
+  ESP_LOGD( LOG_TAG, "Interrupts attached" );
+}
+
+void RotaryEncoder::detachInterrupts()
+{
+  if( backend == ISR_BACKEND )
+  {
+    detachInterrupt( encoderPinA );
+    detachInterrupt( encoderPinB );
+  }
+
+  detachInterrupt( encoderPinButton );
+
+  ESP_LOGD( LOG_TAG, "Interrupts detached" );
+}
+
+void RotaryEncoder::begin( bool useTimer, EncoderBackend backend )
+{
+  resetEncoderValue();
+
+  isrState = ISRState();
+  resetIntervals();
+
+  positionState = PositionState();
+
+  rejectedEdges = 0;
+  invalidTransitions = 0;
+
+  RE_STATS( resetStats() );
+
+  encoderChanges = 0;
+  encoderChangesSeen = 0;
+  buttonReleases = 0;
+  buttonReleasesSeen = 0;
+  buttonPressedTime = 0;
+  buttonPressedDuration = 0;
+
+  turnPending = false;
+  turnWindowOpen = false;
+  reportedValue = getEncoderValue();
+  reportedDetents = 0;
+
+  lowPowerIdle = false;
+  wakePending = false;
+  vccReleased = false;
+
+  pinMode( encoderPinA, encoderPinMode );
+  pinMode( encoderPinB, encoderPinMode );
+
+  if( encoderPinButton > RE_DEFAULT_PIN )
+  {
+    pinMode( encoderPinButton, buttonPinMode );
+
+    if( debounceMode == DEBOUNCE_INTEGRATING && debounceTimer == NULL )
+    {
+      esp_timer_create_args_t _timerConfig;
+      _timerConfig.arg = this;
+      _timerConfig.callback = debounceTimerCallback;
+      _timerConfig.dispatch_method = ESP_TIMER_TASK;
+      _timerConfig.skip_unhandled_events = true;
+      _timerConfig.name = "RotaryEncoder::debounce";
+
+      if( esp_timer_create( &_timerConfig, &debounceTimer ) != ESP_OK )
+      {
+        ESP_LOGE( LOG_TAG, "Could not create the debounce timer; using lockout de-bounce" );
+        debounceTimer = NULL;
+      }
+    }
+  }
+
+  if( encoderPinVcc > RE_DEFAULT_PIN )
+  {
+    pinMode( encoderPinVcc, OUTPUT );
+    digitalWrite( encoderPinVcc, HIGH );
+  }
+
+  if( fastRead )
+    configureFastRead();
+
+  delay( 20 );
+
+  if( encoderPinButton > RE_DEFAULT_PIN )
+  {
+    isrState.buttonDown = !digitalRead( encoderPinButton );
+
+    // As if the last edge were long gone, so that lockout doesn't swallow a press right after boot
+    isrState.lastButtonTime = micros() - debounceTime;
+  }
+
+  // X2 and X1 see half or a quarter of the edges, so a detent is that many fewer steps
+  uint8_t stepsPerDetent = ( ( encoderTripPoint + 1 ) * decodeMode ) / DECODE_X4;
+  decodeTripPoint = ( stepsPerDetent > 1 ) ? stepsPerDetent - 1 : 0;
+
+  if( backend == SCAN_BACKEND )
+    this->backend = SCAN_BACKEND;
+  else
+    this->backend = ( backend == PCNT_BACKEND && beginCounter() ) ? PCNT_BACKEND : ISR_BACKEND;
+
+  attachInterrupts();
+
+  if( useTimer )
+  {
+    if( dispatchMode == DISPATCH_NOTIFY && this->backend != PCNT_BACKEND )
+      beginDispatchTask();
+    else
+      beginLoopTimer();
+  }
+
+  ESP_LOGD( LOG_TAG, "RotaryEncoder active" );
+}
+
+bool RotaryEncoder::isEnabled()
+{
+  return _isEnabled;
+}
+
+void RotaryEncoder::enable()
+{
+  if( _isEnabled )
+    return;
+
+  attachInterrupts();
+
+  #if defined( RE_HAS_PCNT )
+    if( counterUnit != NULL )
+      pcnt_unit_start( counterUnit );
+  #endif
+
+  _isEnabled = true;
+
+  ESP_LOGD( LOG_TAG, "Input enabled" );
+}
+
+void RotaryEncoder::disable()
+{
+  if( !_isEnabled )
+    return;
+
+  detachInterrupts();
+
+  #if defined( RE_HAS_PCNT )
+    if( counterUnit != NULL )
+      pcnt_unit_stop( counterUnit );
+  #endif
+
+  _isEnabled = false;
+
+  ESP_LOGD( LOG_TAG, "Input disabled" );
+}
+
+bool RotaryEncoder::buttonPressed()
+{
+  if( !_isEnabled )
+    return false;
+
+  uint32_t releases = buttonReleases.load( std::memory_order_acquire );
+
+  if( buttonReleasesSeen.exchange( releases ) == releases )
+    return false;
+
+  ESP_LOGD( LOG_TAG, "Button pressed for %lu ms", buttonPressedDuration.load() );
+
+  return true;
+}
+
+bool RotaryEncoder::encoderChanged()
+{
+  if( !takeEncoderChange() )
+    return false;
+
+  RE_STATS( recordReport() );
+
+  ESP_LOGD( LOG_TAG, "Knob turned; value: %ld", getEncoderValue() );
+
+  return true;
+}
+
+bool RotaryEncoder::takeEncoderChange()
+{
+  if( backend == PCNT_BACKEND )
+    pollCounter();
+
+  if( !_isEnabled )
+    return false;
+
+  uint32_t changes = encoderChanges.load( std::memory_order_acquire );
+
+  return encoderChangesSeen.exchange( changes ) != changes;
+}
+
+long RotaryEncoder::getEncoderValue()
+{
+  if( backend == PCNT_BACKEND )
+    pollCounter();
+
+  // Always within the boundaries, since it's constrained as it's written
+  return currentValue.load( std::memory_order_relaxed );
+}
+
+long ARDUINO_ISR_ATTR RotaryEncoder::constrainValue( int64_t value ) const
+{
+  long minValue = minEncoderValue;
+  long maxValue = maxEncoderValue;
+
+  // One unsigned compare catches both ends; most of the time, this is all there is to do.
+  // Unsigned all the way, as the full range of a 64-bit long doesn't fit a signed difference.
+  unsigned long span = (unsigned long)maxValue - (unsigned long)minValue;
+
+  if( (uint64_t)value - (uint64_t)(int64_t)minValue <= span )
+    return (long)value;
+
+  if( !circleValues )
+    return ( value < minValue ) ? minValue : maxValue;
+
+  // Wrap around as many times as needed, e.g. when an accelerated step overshoots the whole range
+  uint64_t range = (uint64_t)span + 1;
+
+  // Only when the boundaries are those of a 64-bit long, which every value is already within
+  if( range == 0 )
+    return (long)value;
+
+  uint64_t offset;
+
+  if( value >= minValue )
+    offset = ( (uint64_t)value - (uint64_t)(int64_t)minValue ) % range;
+
+  else
+  {
+    offset = ( (uint64_t)(int64_t)minValue - (uint64_t)value ) % range;
+    offset = ( offset > 0 ) ? range - offset : 0;
+  }
+
+  return (long)( (uint64_t)(int64_t)minValue + offset );
+}
+
+long ARDUINO_ISR_ATTR RotaryEncoder::addToValue( long delta )
+{
+  long value = currentValue.load( std::memory_order_relaxed );
+  long constrained;
+
+  // Retry if `setEncoderValue()` got in between
+  do
+    constrained = constrainValue( (int64_t)value + delta );
+  while( !currentValue.compare_exchange_weak( value, constrained, std::memory_order_relaxed ) );
+
+  return constrained;
+}
+
+void RotaryEncoder::setCountsPerRevolution( uint32_t counts )
+{
+  ESP_LOGD( LOG_TAG, "Counts per revolution set to %lu", (unsigned long)counts );
+
+  this->countsPerRevolution = counts;
+}
+
+EncoderPosition RotaryEncoder::getPosition()
+{
+  if( backend == PCNT_BACKEND )
+    pollCounter();
+
+  PositionState state = readPosition();
+
+  EncoderPosition position;
+  position.count = state.count;
+  position.timestamp = state.time;
+
+  int64_t perRevolution = countsPerRevolution;
+
+  if( perRevolution > 0 )
+  {
+    position.revolutions = position.count / perRevolution;
+
+    // Division rounds toward zero; the revolution before zero is -1, not 0
+    if( position.count % perRevolution < 0 )
+      position.revolutions--;
+
+    position.step = (uint32_t)( position.count - position.revolutions * perRevolution );
+  }
+  else
+  {
+    position.revolutions = 0;
+    position.step = 0;
+  }
+
+  return position;
+}
+
+void RotaryEncoder::resetPosition( int64_t count )
+{
+  portENTER_CRITICAL( &mux );
+
+  uint32_t sequence = positionSequence.load( std::memory_order_relaxed );
+
+  positionSequence.store( sequence + 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+
+  // Only the count; the knob is still turning as fast as it was
+  positionState.count = count;
+
+  positionSequence.store( sequence + 2, std::memory_order_release );
+
+  portEXIT_CRITICAL( &mux );
+}
+
+void RotaryEncoder::setVelocityTimeout( uint32_t milliseconds )
+{
+  // The average step period is kept in fixed point, which runs out at about 268 seconds
+  if( milliseconds > 60000 )
+  {
+    ESP_LOGW( LOG_TAG, "Velocity timeout %lu ms is too long; using 60000 ms", (unsigned long)milliseconds );
+    milliseconds = 60000;
+  }
+
+  ESP_LOGD( LOG_TAG, "Velocity timeout set to %lu ms", (unsigned long)milliseconds );
+
+  portENTER_CRITICAL( &mux );
+  this->velocityTimeout = milliseconds * 1000UL;
+  portEXIT_CRITICAL( &mux );
+}
+
+float RotaryEncoder::getVelocity()
+{
+  if( backend == PCNT_BACKEND )
+    pollCounter();
+
+  PositionState position = readPosition();
+  uint32_t elapsed = micros() - position.time;
+
+  if( position.period == 0 || elapsed >= velocityTimeout )
+    return 0;
+
+  float period = (float)position.period / ( 1 << RE_VELOCITY_FRACTION );
+
+  // Already longer than the average since the last step, so it must be slowing down
+  if( elapsed > period )
+    period = elapsed;
+
+  return position.direction * 1000000.0f / period;
+}
+
+float RotaryEncoder::getRPM()
+{
+  uint32_t perRevolution = countsPerRevolution;
+
+  if( perRevolution == 0 )
+    return 0;
+
+  return getVelocity() * 60.0f / perRevolution;
+}
+
+RotaryEncoder::PositionState RotaryEncoder::readPosition()
+{
+  PositionState position;
+  uint32_t sequence;
+
+  // Read until the writer wasn't busy before, and didn't start in the meantime
+  do
+  {
+    sequence = positionSequence.load( std::memory_order_acquire );
+
+    position = positionState;
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+  }
+  while( ( sequence & 1 ) || positionSequence.load( std::memory_order_relaxed ) != sequence );
+
+  return position;
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::addToPosition( int64_t steps, unsigned long now, uint32_t detents )
+{
+  uint32_t sequence = positionSequence.load( std::memory_order_relaxed );
+
+  // Odd while `positionState` is being changed; see `readPosition()`
+  positionSequence.store( sequence + 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+
+  PositionState &position = positionState;
+  uint32_t elapsed = now - position.time;
+  int8_t direction = ( steps > 0 ) ? RIGHT : LEFT;
+
+  if( direction != position.direction || elapsed >= velocityTimeout )
+  {
+    // Starting (again), so there's no period yet; this step only starts the clock
+    position.period = 0;
+    position.direction = direction;
+  }
+  else
+  {
+    uint32_t period = elapsed << RE_VELOCITY_FRACTION;
+
+    // Only the pulse counter and recovered steps move more than one step at a time
+    if( steps > 1 || steps < -1 )
+      period /= (uint32_t)( ( steps > 0 ) ? steps : -steps );
+
+    if( position.period == 0 )
+      position.period = period;
+    else
+      position.period += ( period >> RE_VELOCITY_SMOOTHING ) - ( position.period >> RE_VELOCITY_SMOOTHING );
+  }
+
+  position.count += steps;
+  position.time = now;
+
+  if( detents > 0 )
+  {
+    uint32_t sinceDetent = now - position.detentTime;
+
+    // Timed out like the velocity, so the first detent after a pause has no interval
+    position.detentInterval = ( position.detents == 0 || sinceDetent >= velocityTimeout ) ? 0 : sinceDetent;
+    position.detentTime = now;
+    position.detentDirection = direction;
+    position.detents += detents;
+  }
+
+  positionSequence.store( sequence + 2, std::memory_order_release );
+}
+
+void RotaryEncoder::setEncoderValue( long newValue )
+{
+  // Out-of-range values are clamped here, rather than wrapped like turning the knob would
+  long constrained = constrain( newValue, minEncoderValue, maxEncoderValue );
+  long previous = currentValue.exchange( constrained, std::memory_order_relaxed );
+
+  if( previous != constrained )
+    ESP_LOGD( LOG_TAG, "Overriding encoder value from '%ld' to '%ld'", previous, constrained );
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::loop()
+{
+  // Woken up since going idle
+  finishWakeUp();
+
+  if( vccReleased && !lowPowerIdle )
+    restorePower();
+
+  if( callbackEncoderChanged || callbackTurnDetailed )
+  {
+    uint32_t now = millis();
+
+    if( takeEncoderChange() )
+    {
+      turnPending = true;
+      lastTurnTime = now;
+    }
+
+    if( turnPending )
+    {
+      long value = getEncoderValue();
+
+      if( turnDue( now, value ) )
+      {
+        turnPending = false;
+
+        RE_STATS( recordReport() );
+
+        ESP_LOGD( LOG_TAG, "Knob turned; value: %ld", value );
+
+        if( callbackTurnDetailed )
+        {
+          PositionState position = readPosition();
+
+          EncoderTurn turn;
+          turn.value = value;
+          turn.delta = value - reportedValue;
+          turn.detents = position.detents - reportedDetents;
+          turn.direction = position.detentDirection;
+          turn.interval = position.detentInterval;
+          turn.timestamp = position.detentTime;
+
+          reportedDetents = position.detents;
 
+          callbackTurnDetailed( turn );
+        }
 
+        reportedValue = value;
+
+        if( callbackEncoderChanged )
+          callbackEncoderChanged( value );
+      }
+    }
+
+    // Quiet for a whole interval, so the next change starts a new burst
+    else if( turnWindowOpen && now - turnWindowStart >= turnMinInterval )
+      turnWindowOpen = false;
+  }
+
+  if( callbackButtonPressed && buttonPressed() )
+    callbackButtonPressed( buttonPressedDuration.load() );
+
+  if( callbackEvent && eventQueueEnabled )
+  {
+    EncoderEvent events[8];
+    size_t count;
+
+    while( ( count = drainEvents( events, 8 ) ) > 0 )
+      for( size_t i = 0; i < count; i++ )
+        callbackEvent( events[i] );
+  }
+
+  if( idleTimeout > 0 && !lowPowerIdle && backend == ISR_BACKEND && idleRemaining() == 0 )
+    enterIdle();
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::_button_ISR()
+{
+  RE_STATS( uint32_t startCycles = ESP.getCycleCount() );
+
+  // The one timestamp everything about this edge is based on
+  unsigned long now = micros();
+
+  // This edge woke the chip; see `setLowPower()`
+  if( lowPowerIdle )
+    wakeUp();
+
+  portENTER_CRITICAL_ISR( &mux );
+
+  RE_STATS( stats.buttonEdges++ );
+
+  if( captureBuffer != NULL )
+  {
+    captureButton = digitalRead( encoderPinButton ) ? RE_CAPTURE_BUTTON : 0;
+    recordCapture( now, ( isrState.previousAB & 0x03 ) | captureButton | RE_CAPTURE_BUTTON_ISR );
+  }
+
+  if( debounceMode == DEBOUNCE_INTEGRATING && debounceTimer != NULL )
+  {
+    // Every edge restarts the wait; `debounceTimerCallback()` reads the button once it's settled
+    isrState.lastButtonTime = now;
+
+    esp_timer_stop( debounceTimer );
+    esp_timer_start_once( debounceTimer, debounceTime );
+
+    RE_STATS( recordSample( stats.buttonISR, ESP.getCycleCount() - startCycles ) );
+    portEXIT_CRITICAL_ISR( &mux );
+    return;
+  }
+
+  // Lockout de-bounce: ignore everything for a while after an accepted edge
+  if( ( now - isrState.lastButtonTime ) < debounceTime )
+  {
+    RE_STATS( recordSample( stats.buttonISR, ESP.getCycleCount() - startCycles ) );
+    portEXIT_CRITICAL_ISR( &mux );
+    return;
+  }
+
+  // HIGH = idle, LOW = active
+  bool isPressed = !digitalRead( encoderPinButton );
+  bool report = buttonEdge( isPressed, now );
+
+  RE_STATS( recordSample( stats.buttonISR, ESP.getCycleCount() - startCycles ) );
+  portEXIT_CRITICAL_ISR( &mux );
+
+  if( report )
+    notifyDispatcher();
+}
+
+bool ARDUINO_ISR_ATTR RotaryEncoder::buttonEdge( bool isPressed, unsigned long now )
+{
+  // Already in that state, so this edge was just bounce
+  if( isPressed == isrState.buttonDown )
+    return false;
+
+  isrState.buttonDown = isPressed;
+  isrState.lastButtonTime = now;
+
+  if( isPressed )
+  {
+    buttonPressedTime = now;
+
+    if( eventQueueEnabled )
+      pushEvent( BUTTON_PRESSED, 0, now );
+  }
+  else
+  {
+    unsigned long duration = ( now - buttonPressedTime ) / 1000;
+
+    buttonPressedDuration.store( duration, std::memory_order_relaxed );
+    buttonReleases.fetch_add( 1, std::memory_order_release );
+
+    if( eventQueueEnabled )
+      pushEvent( BUTTON_RELEASED, duration, now );
+  }
+
+  if( gestureTimer != NULL )
+    gestureEdge( isPressed, esp_timer_get_time() );
+
+  // A release is what `loop()` reports; a press only matters to the event queue
+  return !isPressed || eventQueueEnabled;
+}
+
+void RotaryEncoder::debounceTimerCallback( void *arg )
+{
+  RotaryEncoder *instance = (RotaryEncoder *)arg;
+
+  portENTER_CRITICAL( &instance->mux );
+
+  // Time it as of the last edge, which is when the button actually settled
+  bool isPressed = !digitalRead( instance->encoderPinButton );
+  bool report = instance->buttonEdge( isPressed, instance->isrState.lastButtonTime );
+
+  portEXIT_CRITICAL( &instance->mux );
+
+  // Not in an ISR here, so this can't use `notifyDispatcher()`
+  if( report && instance->dispatchTask != NULL )
+    xTaskNotifyGive( instance->dispatchTask );
+}
+
+void ARDUINO_ISR_ATTR RotaryEncoder::_encoder_ISR()
+{
+  RE_STATS( uint32_t startCycles = ESP.getCycleCount() );
+
+  unsigned long now = micros();
+
+  // This edge woke the chip; see `setLowPower()`
+  if( lowPowerIdle )
+    wakeUp();
+
+  portENTER_CRITICAL_ISR( &mux );
+
+  RE_STATS( stats.edges++ );
+
+  // Read once, so that a capture records exactly what the decoder was given
+  uint8_t ab = readAB();
+
+  // Recorded before the glitch filter has its say, since the point is to see what the pins did
+  if( captureBuffer != NULL )
+    recordCapture( now, ab | captureButton );
+
+  if( glitchFilter )
+  {
+    // Too soon after the last edge to be a real step; bounce or noise
+    if( now - isrState.lastEdgeTime < glitchFilter )
+    {
+      rejectedEdges++;
+      RE_STATS( recordSample( stats.encoderISR, ESP.getCycleCount() - startCycles ) );
+      portEXIT_CRITICAL_ISR( &mux );
+      return;
+    }
+
+    isrState.lastEdgeTime = now;
+  }
+
+  bool valueChanged = processTransition( ab, now );
+
+  RE_STATS( recordSample( stats.encoderISR, ESP.getCycleCount() - startCycles ) );
+  portEXIT_CRITICAL_ISR( &mux );
+
+  if( valueChanged )
+    notifyDispatcher();
+}
+
+bool ARDUINO_ISR_ATTR RotaryEncoder::processTransition( uint8_t ab, unsigned long now )
+{
   /**
-   * Update counter if encoder has rotated a full detent
-   * For the following comments, we'll assume it's 4 steps per detent
-   * The tripping point is `STEPS - 1` (so, 3 in this example)
+   * Almost all of this came from a blog post by Garry on GarrysBlog.com:
+   * https://garrysblog.com/2021/03/20/reliably-debouncing-rotary-encoders-with-arduino-and-esp32/
+   *
+   * Read more about how this works here:
+   * https://www.best-microcontroller-projects.com/rotary-encoder.html
    */
 
-  if( _encoderPosition > encoderTripPoint )        // Four steps forward
+  bool valueChanged = false;
+
+  isrState.previousAB = ( isrState.previousAB << 2 ) | ab;  // Remember previous state
+
+  int8_t rotation;
+
+  if( decodeMode == DECODE_X4 )
   {
-    this->currentValue += _stepValue;
-    valueChanged = true;
+    uint8_t transition = isrState.previousAB & 0x0f;
+    rotation = encoderStates[transition];
+
+    if( rotation != STILL )
+      isrState.lastRotation = rotation;
+
+    else if( ( 0x1248 >> transition ) & 0x01 )
+    {
+      // 00->11, 01->10, 10->01 or 11->00: both pins changed, so an edge went missing
+      invalidTransitions++;
+
+      if( glitchFilter )
+        rotation = 2 * isrState.lastRotation;
+    }
   }
-  else if( _encoderPosition < -encoderTripPoint )  // Four steps backwards
+
+  else if( decodeMode == DECODE_X2 )
   {
-    this->currentValue -= _stepValue;
-    valueChanged = true;
+    // Only A interrupts (on both edges); turning right, A has just become different from B
+    rotation = ( ( ab >> 1 ) != ( ab & 0x01 ) ) ? RIGHT : LEFT;
   }
 
-  if( valueChanged )
+  else
+  {
+    // Only A rising interrupts; turning right, B is still low at that point
+    if( ab & 0x02 )
+      rotation = ( ab & 0x01 ) ? LEFT : RIGHT;
+    else
+      rotation = STILL;  // A is low again already; just a spike
+  }
+
+  isrState.encoderPosition += rotation;
+
+  bool detent = isrState.encoderPosition > decodeTripPoint || isrState.encoderPosition < -decodeTripPoint;
+
+  if( rotation != STILL )
+    addToPosition( rotation, now, detent ? 1 : 0 );
+
+
+  /**
+   * Update counter if encoder has rotated a full detent
+   * For the following comments, we'll assume it's 4 steps per detent (in X4)
+   * The tripping point is `STEPS - 1` (so, 3 in this example), scaled down
+   * for X2 and X1 since fewer edges are seen
+   */
+
+  if( detent )
   {
-    encoderChangedFlag = true;
+    /**
+     * Based on how fast the encoder is being turned, we can apply an acceleration factor.
+     * The time since the last detent (averaged over the last few detents) picks the step
+     * out of the table prepared by `buildAccelerationTable()`.
+     */
+
+    uint32_t interval = now - isrState.lastDetentTime;
+
+    if( interval > RE_ACCEL_MAX_INTERVAL )
+      interval = RE_ACCEL_MAX_INTERVAL;
+
+    uint8_t slot = isrState.intervalIndex;
+    isrState.intervalSum += interval - isrState.intervals[slot];
+    isrState.intervals[slot] = interval;
+    isrState.intervalIndex = ( slot + 1 ) & ( ( 1 << accelerationSmoothing ) - 1 );
+
+    uint32_t bucket = ( isrState.intervalSum >> accelerationSmoothing ) >> RE_ACCEL_SHIFT;
 
-    // Reset our "step counter"
-    _encoderPosition = 0;
+    long _stepValue = accelerationSteps[( bucket < RE_ACCEL_BUCKETS ) ? bucket : RE_ACCEL_BUCKETS - 1];
+
+    if( isrState.encoderPosition > 0 )             // Four steps forward
+    {
+      addToValue( _stepValue );
+
+      if( eventQueueEnabled )
+        pushEvent( TURNED_RIGHT, _stepValue, now );
+    }
+    else                                           // Four steps backwards
+    {
+      addToValue( -_stepValue );
+
+      if( eventQueueEnabled )
+        pushEvent( TURNED_LEFT, -_stepValue, now );
+    }
+
+    valueChanged = true;
+    encoderChanges.fetch_add( 1, std::memory_order_release );
+
+    RE_STATS( recordDetents( 1, now ) );
+
+    // Reset our "step counter", keeping the step a recovered double step took past the detent
+    int8_t stepsPerDetent = decodeTripPoint + 1;
+    isrState.encoderPosition += ( isrState.encoderPosition > 0 ) ? -stepsPerDetent : stepsPerDetent;
 
     // Remember current time so we can calculate speed
-    _lastInterruptTime = micros();
+    isrState.lastDetentTime = now;
   }
 
-  portEXIT_CRITICAL_ISR( &mux );
+  return valueChanged;
 }
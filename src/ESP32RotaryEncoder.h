@@ -1,7 +1,10 @@
 #ifndef _RotaryEncoder_h
 #define _RotaryEncoder_h
 
-#if defined( ARDUINO ) && ARDUINO >= 100
+#if defined( RE_HOST_BUILD )
+  #include "RotaryEncoderHost.h"
+
+#elif defined( ARDUINO ) && ARDUINO >= 100
   #include <Arduino.h>
 
 #elif defined( WIRING )
@@ -16,23 +19,33 @@
 #if defined( ESP32 )
   #define RE_ISR_ATTR IRAM_ATTR
 
+  #include <soc/soc.h>
+  #include <soc/gpio_reg.h>
+  #include <driver/gpio.h>
+  #include <hal/gpio_ll.h>
+  #include <esp_sleep.h>
+  #include <freertos/timers.h>
+
   #ifdef ARDUINO_ISR_ATTR
     #undef ARDUINO_ISR_ATTR
     #define ARDUINO_ISR_ATTR IRAM_ATTR
   #endif
 
-  #if defined( ESP_ARDUINO_VERSION ) && ( ESP_ARDUINO_VERSION == ESP_ARDUINO_VERSION_VAL(2,0,10) )
-    /**
-     * BUG ALERT!
-     *
-     * With Arduino-ESP32 core 2.0.10, the #include statement below
-     * fails to compile due to a bug.
-     * Also see `attachInterrupts()` in ESP32RotaryEncoder.cpp for
-     * the note about the `attachInterrupt()` macro in 2.x cores.
-     */
-    #error Please upgrade the Arduino-ESP32 core to use this library.
-  #else
-    #include <FunctionalInterrupt.h>
+#endif
+
+#include <atomic>
+
+#include "RotaryEncoderDelegate.h"
+
+#if defined( RE_HOST_BUILD )
+  #define RE_HAS_PCNT 1
+
+#elif defined( ESP32 ) && __has_include( <driver/pulse_cnt.h> )
+  #include <soc/soc_caps.h>
+
+  #if SOC_PCNT_SUPPORTED
+    #include <driver/pulse_cnt.h>
+    #define RE_HAS_PCNT 1
   #endif
 #endif
 
@@ -40,24 +53,204 @@
 #define RE_DEFAULT_STEPS 4
 #define RE_LOOP_INTERVAL 100000U  // 0.1 seconds
 
+#ifndef RE_DISPATCH_STACK_SIZE
+  #define RE_DISPATCH_STACK_SIZE 4096  // Stack of the dispatcher task used by DISPATCH_NOTIFY
+#endif
+
+#ifndef RE_DISPATCH_PRIORITY
+  #define RE_DISPATCH_PRIORITY 10
+#endif
+
+#ifndef RE_PCNT_GLITCH_NS
+  #define RE_PCNT_GLITCH_NS 1000  // Pulses shorter than this are ignored by the PCNT backend
+#endif
+
+#ifndef RE_ACCEL_BUCKETS
+  #define RE_ACCEL_BUCKETS 32         // Number of entries in the acceleration table
+#endif
+
+#ifndef RE_ACCEL_SHIFT
+  #define RE_ACCEL_SHIFT 11           // Each entry covers 2^11 us (~2 ms) of time between detents
+#endif
+
+#define RE_ACCEL_MAX_INTERVAL ( (uint32_t)RE_ACCEL_BUCKETS << RE_ACCEL_SHIFT )
+#define RE_ACCEL_SMOOTHING_MAX 8      // Most detents that can be averaged; must be a power of 2
+
+#ifndef RE_EVENT_QUEUE_SIZE
+  #define RE_EVENT_QUEUE_SIZE 16  // Must be a power of 2
+#endif
+
 typedef enum {
   FLOATING,
   HAS_PULLUP,
   SW_FLOAT
 } EncoderType;
 
+typedef enum {
+  ISR_BACKEND,      // GPIO interrupts on A and B, decoded in software
+  PCNT_BACKEND,     // The pulse counter peripheral decodes A and B; no interrupts at all
+  SCAN_BACKEND      // `RotaryEncoderManager::scan()` samples A and B along with every other scanned encoder
+} EncoderBackend;
+
+typedef enum {
+  DISPATCH_TIMER,   // A periodic timer runs `loop()` every RE_LOOP_INTERVAL (default)
+  DISPATCH_NOTIFY   // The ISRs wake a dispatcher task that runs `loop()` only when something happened
+} DispatchMode;
+
+typedef enum {
+  DECODE_X1 = 1,    // Count one edge per quadrature cycle
+  DECODE_X2 = 2,    // Count both edges of A
+  DECODE_X4 = 4     // Count both edges of A and B (default)
+} DecodeMode;
+
+typedef enum {
+  ACCEL_NONE,         // Always change by the step value
+  ACCEL_DEFAULT,      // 3x the step value under ~40 ms per detent (if step > 9), 10x under ~20 ms (if step > 100)
+  ACCEL_LINEAR,       // Multiplier grows linearly from 1x (slowest) to the maximum (fastest)
+  ACCEL_EXPONENTIAL,  // Multiplier grows exponentially from 1x (slowest) to the maximum (fastest)
+  ACCEL_CUSTOM        // Multipliers given to `setAccelerationTable()`
+} AccelerationProfile;
+
+typedef enum {
+  TURNED_RIGHT,
+  TURNED_LEFT,
+  BUTTON_PRESSED,
+  BUTTON_RELEASED
+} EncoderEventType;
+
+typedef enum {
+  DEBOUNCE_LOCKOUT,     // Act on the first edge, then ignore the button for the debounce time (default)
+  DEBOUNCE_INTEGRATING  // Act once the button has stayed put for the debounce time
+} DebounceMode;
+
+#ifndef RE_DEBOUNCE_US
+  #define RE_DEBOUNCE_US 30000  // 30 milliseconds
+#endif
+
+typedef enum {
+  BUTTON_CLICK,         // Pressed and released (and not pressed again within the double-click time)
+  BUTTON_DOUBLE_CLICK,  // Pressed twice within the double-click time; reported on the second release
+  BUTTON_LONG_PRESS,    // Held down for the long-press time; reported while still held
+  BUTTON_REPEAT         // Still held after a long press; reported every repeat interval
+} ButtonGesture;
+
+#ifndef RE_LONG_PRESS_MS
+  #define RE_LONG_PRESS_MS 500
+#endif
+
+#ifndef RE_DOUBLE_CLICK_MS
+  #define RE_DOUBLE_CLICK_MS 250
+#endif
+
+#ifndef RE_REPEAT_MS
+  #define RE_REPEAT_MS 100
+#endif
+
+#ifndef RE_VELOCITY_TIMEOUT_MS
+  #define RE_VELOCITY_TIMEOUT_MS 500  // How long without a step before the velocity is 0
+#endif
+
+#ifndef RE_VELOCITY_SMOOTHING
+  #define RE_VELOCITY_SMOOTHING 2     // Each step period counts for 1/2^2 of the average
+#endif
+
+#define RE_VELOCITY_FRACTION 4        // Fractional bits of the average step period
+
+#define RE_CAPTURE_B           0x01  // Level of pin B in a capture entry; see `startCapture()`
+#define RE_CAPTURE_A           0x02  // Level of pin A
+#define RE_CAPTURE_BUTTON      0x04  // Level of the button pin (HIGH when released)
+#define RE_CAPTURE_BUTTON_ISR  0x08  // Set if recorded by the button ISR, clear if by the encoder ISR
+#define RE_CAPTURE_TIME_SHIFT  4     // The bits above those are micros(), modulo 2^28 (~4.5 minutes)
+
+#ifndef RE_ENABLE_STATS
+  #define RE_ENABLE_STATS 0  // 1 to count edges and time the ISRs; see `getStats()`
+#endif
+
+#ifndef RE_STATS_BUCKETS
+  #define RE_STATS_BUCKETS 20  // Buckets per histogram; the last one starts at 2^19 (~0.5 s in microseconds)
+#endif
+
+/**
+ * @brief A single knob or button event, as recorded by the ISRs in the event queue.
+ *
+ * See `setEventQueue()`.
+ *
+ */
+typedef struct {
+  uint32_t timestamp;     // micros() when the event happened
+  long value;             // TURNED_RIGHT/TURNED_LEFT: the signed step applied to the value (after acceleration)
+                          // BUTTON_RELEASED: how long the button was down, in milliseconds
+                          // BUTTON_PRESSED: always 0
+  uint8_t type;           // An EncoderEventType
+} EncoderEvent;
+
+/**
+ * @brief Where the knob is, in raw steps, as returned by `getPosition()`.
+ *
+ */
+typedef struct {
+  int64_t count;          // Steps counted since `begin()` (or `resetPosition()`); right is positive
+  int64_t revolutions;    // Whole turns, rounded down (so -1 just left of zero); 0 without `setCountsPerRevolution()`
+  uint32_t step;          // Steps into the current turn, from 0 up to counts per revolution - 1; 0 without `setCountsPerRevolution()`
+  uint32_t timestamp;     // micros() when `count` last changed
+} EncoderPosition;
+
+/**
+ * @brief What happened to the knob since the last call, as passed to `onTurnedDetailed()`.
+ *
+ */
+typedef struct {
+  long value;             // The current value, the same as `onTurned()` gets
+  long delta;             // How far the value moved since the last call (after acceleration and boundaries)
+  uint32_t detents;       // Detents since the last call
+  int8_t direction;       // Direction of the last detent: 1 to the right, -1 to the left
+  uint32_t interval;      // Microseconds between the last two detents; 0 if the knob was still before the last one
+  uint32_t timestamp;     // micros() of the last detent
+} EncoderTurn;
+
+/**
+ * @brief A log2 histogram of samples, along with the smallest and largest.
+ *
+ * `buckets[0]` counts samples of 0 and 1, and `buckets[n]` counts samples from 2^n
+ * up to 2^(n+1) - 1; the last bucket also counts everything bigger than that.
+ *
+ */
+typedef struct {
+  uint32_t count;
+  uint32_t min;           // Only meaningful once `count` is non-zero
+  uint32_t max;
+  uint32_t buckets[RE_STATS_BUCKETS];
+} EncoderHistogram;
+
+/**
+ * @brief Counters and timings of one encoder, as returned by `getStats()`.
+ *
+ */
+typedef struct {
+  uint32_t edges;                 // Encoder interrupts, including those the glitch filter rejected
+  uint32_t detents;               // Detents decoded, by the ISR or the pulse counter
+  uint32_t buttonEdges;           // Button interrupts, bounce included
+  uint32_t reports;               // Times `encoderChanged()` returned true, or `loop()` called `onTurned()`
+  uint32_t coalesced;             // Detents reported together with an earlier one, rather than on their own
+  EncoderHistogram encoderISR;    // CPU cycles spent in each run of `_encoder_ISR()`
+  EncoderHistogram buttonISR;     // CPU cycles spent in each run of `_button_ISR()`
+  EncoderHistogram latency;       // Microseconds from the first detent of a report to it reaching the application
+} EncoderStats;
+
+class RotaryEncoderManager;
+
 class RotaryEncoder {
 
+  friend class RotaryEncoderManager;
+
   protected:
     mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
 
-    #if defined( ESP32 )
-      typedef std::function<void(long)> EncoderCallback;
-      typedef std::function<void(unsigned long)> ButtonCallback;
-    #else
-      typedef void (*EncoderCallback)(long);
-      typedef void (*ButtonCallback)(unsigned long);
-    #endif
+    typedef RotaryEncoderDelegate<void(long)> EncoderCallback;
+    typedef RotaryEncoderDelegate<void(const EncoderTurn &)> TurnCallback;
+    typedef RotaryEncoderDelegate<void(unsigned long)> ButtonCallback;
+    typedef RotaryEncoderDelegate<void(const EncoderEvent &)> EventCallback;
+    typedef RotaryEncoderDelegate<void(ButtonGesture)> GestureCallback;
 
 
   public:
@@ -99,11 +292,12 @@ class RotaryEncoder {
     /**
      * @brief Set the minimum and maximum values that the encoder will return.
      *
-     * @note This is a convenience function that calls `setMinValue()`, `setMaxValue()`, and `setCircular()`
+     * @note This is a convenience function equivalent to `setMinValue()`, `setMaxValue()`, and `setCircular()`
      *
      * @param minValue      Minimum value (e.g. 0)
      * @param maxValue      Maximum value (e.g. 10)
-     * @param circleValues  If true, turning past the maximum will wrap around to the minimum and vice-versa
+     * @param circleValues  If true, turning past the maximum will wrap around to the minimum and vice-versa,
+     *                      carrying over however far the step went past the boundary
      *                      If false (default), turning past the minimum or maximum will return that boundary
      */
     void setBoundaries( long minValue, long maxValue, bool circleValues = false );
@@ -144,6 +338,179 @@ class RotaryEncoder {
      */
     void setStepValue( long stepValue );
 
+    /**
+     * @brief Set how the step value is multiplied when the knob is turned quickly.
+     *
+     * The time between detents is divided into `RE_ACCEL_BUCKETS` buckets of about 2 ms
+     * each (`RE_ACCEL_SHIFT`), and the profile decides the multiplier for each bucket.
+     * The resulting table is computed here (and whenever the step value changes), so
+     * the ISR only has to look up the step to apply.
+     *
+     * @note Call this in `setup()`.  May be set/changed at runtime if needed.
+     *
+     * @param profile        ACCEL_NONE, ACCEL_DEFAULT (default), ACCEL_LINEAR or ACCEL_EXPONENTIAL
+     * @param maxMultiplier  Optional; the multiplier at the fastest speed for ACCEL_LINEAR
+     *                       and ACCEL_EXPONENTIAL; defaults to 10
+     */
+    void setAcceleration( AccelerationProfile profile, uint16_t maxMultiplier = 10 );
+
+    /**
+     * @brief Set a custom table of step multipliers.
+     *
+     * Entry `n` is the multiplier when there were between `n` and `n + 1` times 2^`RE_ACCEL_SHIFT`
+     * microseconds between detents, so the first entry applies to the fastest turns.  Entries
+     * beyond `count` are 1.  The table is copied, so it need not outlive this call.
+     *
+     * @note Call this in `setup()`.  May be set/changed at runtime if needed.
+     *
+     * @param multipliers  The multipliers, fastest first
+     * @param count        Number of multipliers; at most `RE_ACCEL_BUCKETS`
+     */
+    void setAccelerationTable( const uint16_t *multipliers, size_t count );
+
+    /**
+     * @brief Set how many detents the speed is averaged over for acceleration.
+     *
+     * Averaging over a few detents stops a single quick (or slow) detent from making
+     * the value jump (or stall) in the middle of a steady turn.
+     *
+     * @note Call this in `setup()`.  May be set/changed at runtime if needed.
+     *
+     * @param detents  1 (default, no averaging), 2, 4 or 8; other values are rounded down
+     */
+    void setAccelerationSmoothing( uint8_t detents );
+
+    /**
+     * @brief Read both encoder pins from one snapshot of the GPIO input register.
+     *
+     * By default, the encoder ISR calls `digitalRead()` once for each pin.  With this enabled,
+     * it reads the GPIO input register once and picks out both pins, which is cheaper and
+     * guarantees that A and B are sampled at the same instant, which matters on fast edges.
+     *
+     * @note Call this in `setup()` before `begin()`.  If A and B are not in the same GPIO
+     *       bank (e.g. GPIO 27 and GPIO 35 on an ESP32), this has no effect.
+     *
+     * @param fastRead  true to read from the register snapshot, false to use `digitalRead()`
+     */
+    void setFastRead( bool fastRead = true );
+
+    /**
+     * @brief Ignore edges that come too soon after the last one, and recover skipped steps.
+     *
+     * With a filter set, any edge on A or B less than `microseconds` after the last edge
+     * that was accepted is counted (see `getRejectedEdges()`) and otherwise ignored, which
+     * keeps contact bounce and noise spikes from ever reaching the decoder.  The decoder
+     * also stops treating a transition where both pins changed at once (an edge was missed)
+     * as standing still, and counts it as two steps in the direction it was last going.
+     *
+     * Choose a filter shorter than the time between edges at the fastest expected turn,
+     * but longer than the contacts bounce for: a bounce that outlasts it is taken as a
+     * step back.  A few hundred microseconds suits most hand-turned knobs.
+     *
+     * @note Only applies to the ISR backend; see `RE_PCNT_GLITCH_NS` for the PCNT backend.
+     *
+     * @param microseconds  Minimum time between edges; 0 (default) to accept every edge
+     */
+    void setGlitchFilter( uint32_t microseconds );
+
+    /**
+     * @brief Get the number of edges ignored by the glitch filter since `begin()`.
+     *
+     */
+    uint32_t getRejectedEdges() { return rejectedEdges; }
+
+    /**
+     * @brief Get the number of transitions since `begin()` where both pins changed at once,
+     * meaning an edge was missed or the wiring is noisy.
+     *
+     */
+    uint32_t getInvalidTransitions() { return invalidTransitions; }
+
+    /**
+     * @brief Set how many quadrature edges are counted per cycle.
+     *
+     * `DECODE_X4` counts every edge of both pins, which is what most detented knobs
+     * need.  `DECODE_X2` and `DECODE_X1` count fewer edges, and the number of steps per
+     * detent given to the constructor is scaled down to match (e.g. 4 steps per detent
+     * in X4 is 2 in X2 and 1 in X1).  A mode that would leave a detent a fraction of a
+     * step, like X1 with 2 steps per detent, is refused and the decode mode is left as it was.
+     *
+     * With the ISR backend, this also cuts the number of interrupts: X2 only interrupts
+     * on both edges of A, and X1 only on A rising, reading B to tell the direction.
+     * That's 2 or 4 times fewer interrupts per detent, but there's no longer any way to
+     * tell a bounce or a missed edge from a real step, so X4 copes better with noisy
+     * contacts (and only X4 uses `setGlitchFilter()`'s recovery of skipped steps).
+     *
+     * @note Call this in `setup()` before `begin()`.
+     *
+     * @param mode  DECODE_X1, DECODE_X2 or DECODE_X4
+     */
+    void setDecodeMode( DecodeMode mode );
+
+    /**
+     * @brief Set how `loop()` is run when `begin()` is told to use a timer.
+     *
+     * With `DISPATCH_TIMER` (default), a periodic timer runs `loop()` every `RE_LOOP_INTERVAL`,
+     * so callbacks fire up to that long after the knob was turned, and the timer wakes the
+     * CPU all the time even when nothing is happening.
+     *
+     * With `DISPATCH_NOTIFY`, a dispatcher task sleeps until an ISR notifies it that the
+     * knob was turned or the button was released, then runs `loop()` right away (or after
+     * the coalescing window, see `setCoalesceWindow()`).  There are no wakeups while idle.
+     *
+     * @note Call this in `setup()` before `begin()`.  The PCNT backend has no ISR to wake
+     *       the task, so it always uses `DISPATCH_TIMER`.
+     *
+     * @param mode  DISPATCH_TIMER or DISPATCH_NOTIFY
+     */
+    void setDispatchMode( DispatchMode mode );
+
+    /**
+     * @brief Set how long the dispatcher waits after being woken before running `loop()`.
+     *
+     * Anything else that happens during this window is handled in the same `loop()`, so
+     * a fast spin results in fewer callbacks.  0 (default) means no waiting.
+     *
+     * @note Only used with `DISPATCH_NOTIFY`.  May be set/changed at runtime if needed.
+     *
+     * @param milliseconds  Length of the window
+     */
+    void setCoalesceWindow( uint32_t milliseconds );
+
+    /**
+     * @brief Stop waking the CPU once the knob and button have been left alone for a while,
+     * so a battery-powered project can stay in light sleep.
+     *
+     * After `idleMs` without a step or a button edge, `loop()` stops the loop timer (with
+     * `DISPATCH_NOTIFY`, the dispatcher just stops waking up) and makes A, B and the button
+     * light-sleep wake sources, each on the level it isn't at, so any change wakes the chip.
+     * The pin that woke it then interrupts like on any other edge and is decoded as usual,
+     * so the first detent after waking isn't lost; the pins go back to their edge interrupts
+     * and the loop timer starts again until the next idle spell.
+     *
+     * With `switchVcc`, `encoderPinVcc` is also let go (set as an input) while idle, so the
+     * module's pull-up resistors draw nothing, and the internal pull-ups are turned on in
+     * their place so the knob can still wake the chip.  The first `loop()` after waking up
+     * powers the encoder again.
+     *
+     * Going to sleep is still up to you (`esp_light_sleep_start()`, or automatic light sleep
+     * with power management); `esp_sleep_enable_gpio_wakeup()` is called here.
+     *
+     * @note Only the ISR backend can go idle: the pulse counter doesn't count in light sleep,
+     *       and the scan backend runs from a timer.  The loop timer of `RotaryEncoderManager`
+     *       is shared and keeps running, so use `DISPATCH_NOTIFY` with managed encoders.
+     *
+     * @param idleMs     How long without activity before going idle, up to an hour; 0 (default) to never
+     * @param switchVcc  true to power the encoder through `encoderPinVcc` only while active
+     */
+    void setLowPower( uint32_t idleMs, bool switchVcc = false );
+
+    /**
+     * @brief Whether the encoder has gone idle (see `setLowPower()`) and nothing has woken it yet.
+     *
+     */
+    bool isIdle();
+
     /**
      * @brief Set a function to fire every time the value tracked by the encoder changes.
      *
@@ -154,6 +521,51 @@ class RotaryEncoder {
      */
     void onTurned( EncoderCallback f );
 
+    /**
+     * @brief Like `onTurned()`, but the function gets an `EncoderTurn` with the change
+     * since its last call (how far and how many detents), the direction, and when the
+     * last detent happened and how long after the one before it.
+     *
+     * This saves keeping the previous value around to work out which way the knob went,
+     * and the interval gives a feel for how fast it's being turned.  Everything is read
+     * from what the ISRs already keep, without a lock.  Both callbacks may be set; they're
+     * called together, and `setTurnedPolicy()` applies to both.
+     *
+     * @note On circular boundaries, wrapping around shows up in `delta` as a jump across
+     *       the range; `detents` and `direction` still say which way the knob went.
+     *
+     * @param handler The function to call; it must accept a `const EncoderTurn &`
+     */
+    void onTurnedDetailed( TurnCallback f );
+
+    /**
+     * @brief Set when `loop()` may call `onTurned()`, to spare a callback that's expensive
+     * (redrawing a display, sending a setpoint over the network) during a fast spin.
+     *
+     * Without a policy (the default), `onTurned()` is called on every `loop()` that finds
+     * the value changed.  With one, the change is held back until all of these allow it:
+     *
+     * - The value is at least `minDelta` away from the value last reported.
+     * - The knob has been still for `settleMs` (e.g. only call once the user lets go).
+     * - At most one call per `minIntervalMs`.  With `leading`, the first change after a
+     *   quiet spell is reported straight away; with `trailing`, the latest value is reported
+     *   when the interval runs out, so the final value is never lost; with both, the
+     *   callback fires at both ends of a burst and at most once per interval in between.
+     *
+     * The checks are a few compares in `loop()`; nothing is added to the ISRs.
+     *
+     * @note With `DISPATCH_TIMER`, `loop()` only runs every `RE_LOOP_INTERVAL`, so that's the
+     *       resolution of the times here; with `DISPATCH_NOTIFY`, the dispatcher task also
+     *       wakes when a held-back change comes due.
+     *
+     * @param minIntervalMs  Shortest time between calls; 0 for no limit
+     * @param minDelta       Smallest change of value worth a call (default 0, any change)
+     * @param settleMs       How long the knob must be still before a call (default 0, no wait)
+     * @param leading        Call at the start of a burst (default true)
+     * @param trailing       Call at the end of a burst (default true)
+     */
+    void setTurnedPolicy( uint32_t minIntervalMs, long minDelta = 0, uint32_t settleMs = 0, bool leading = true, bool trailing = true );
+
     /**
      * @brief Set a function to fire every time the the pushbutton is pressed.
      *
@@ -164,13 +576,173 @@ class RotaryEncoder {
      */
     void onPressed( ButtonCallback f );
 
+    /**
+     * @brief Set how the pushbutton is de-bounced.
+     *
+     * `DEBOUNCE_LOCKOUT` reacts on the very first edge, then ignores the button until
+     * `microseconds` have passed, so it's the most responsive; but a switch that bounces
+     * for longer than that can still register twice.  `DEBOUNCE_INTEGRATING` waits
+     * until the button hasn't changed for `microseconds` (using a one-shot timer), so it
+     * never registers bounce, at the cost of reacting that much later.
+     *
+     * Either way, an edge that leaves the button in the state it was already in is
+     * ignored, so a press is never counted twice.
+     *
+     * @note Call this in `setup()` before `begin()`.
+     *
+     * @param microseconds  The debounce time (default `RE_DEBOUNCE_US`, 30 ms)
+     * @param mode          DEBOUNCE_LOCKOUT (default) or DEBOUNCE_INTEGRATING
+     */
+    void setButtonDebounce( uint32_t microseconds, DebounceMode mode = DEBOUNCE_LOCKOUT );
+
+    /**
+     * @brief Set a function to fire on button clicks, double-clicks, long presses and
+     * auto-repeats.
+     *
+     * The button ISR drives a small state machine, and a one-shot timer is armed only
+     * while a gesture is in progress (waiting for a long press, a repeat, or a possible
+     * second click), so nothing runs at all while the button is idle.  The function is
+     * called from that timer, just like the `onTurned()` and `onPressed()` callbacks are
+     * called from the loop timer.
+     *
+     * This works alongside `onPressed()`, which still fires on every release.
+     *
+     * @note Call this in `setup()`.  May be set/changed at runtime if needed.
+     *
+     * @param f  The function to call; it must accept one parameter of type ButtonGesture
+     */
+    void onButtonGesture( GestureCallback f );
+
+    /**
+     * @brief Set the timing of the gestures reported to `onButtonGesture()`.
+     *
+     * @note Call this in `setup()`.  May be set/changed at runtime if needed.
+     *
+     * @param longPressMs    How long the button must be held for BUTTON_LONG_PRESS;
+     *                       0 for no long presses (default `RE_LONG_PRESS_MS`)
+     * @param doubleClickMs  How soon the second click must start for BUTTON_DOUBLE_CLICK;
+     *                       0 for no double-clicks, which also makes BUTTON_CLICK fire
+     *                       straight away on release (default `RE_DOUBLE_CLICK_MS`)
+     * @param repeatMs       How often BUTTON_REPEAT fires while held after a long press;
+     *                       0 for no repeats (default `RE_REPEAT_MS`)
+     */
+    void setGestureTiming( uint32_t longPressMs, uint32_t doubleClickMs = RE_DOUBLE_CLICK_MS, uint32_t repeatMs = RE_REPEAT_MS );
+
+    /**
+     * @brief Record every detent and button press/release in a queue instead of only the latest state.
+     *
+     * Normally, any number of detents between two runs of `loop()` are collapsed into a
+     * single `onTurned()` call with the latest value, and a second button press before
+     * the first was handled is lost.  With the event queue enabled, the ISRs also record
+     * each event (with a timestamp) in a lock-free ring of `RE_EVENT_QUEUE_SIZE` entries,
+     * which can then be consumed in order, either by `loop()` calling the `onEvent()`
+     * handler, or by calling `drainEvents()` yourself.
+     *
+     * If the queue fills up before it's drained, new events are dropped and counted
+     * (see `getEventOverflows()`).
+     *
+     * @note Call this in `setup()`.  Use either `onEvent()` or `drainEvents()`, not both.
+     *
+     * @param enabled  true to record events, false to stop recording (queued events are discarded)
+     */
+    void setEventQueue( bool enabled = true );
+
+    /**
+     * @brief Set a function to fire for every event recorded in the event queue.
+     *
+     * @note Call this in `setup()`.  Requires `setEventQueue()`.
+     *
+     * @param handler The function to call; it must accept one parameter of
+     *                type `const EncoderEvent &`, which will be the event
+     */
+    void onEvent( EventCallback f );
+
+    /**
+     * @brief Take events out of the event queue, oldest first.
+     *
+     * This never blocks the ISRs, so it's safe to call as often as you like.
+     *
+     * @param events     Where to copy the events to
+     * @param maxEvents  The most events to copy (size of `events`)
+     *
+     * @return The number of events copied
+     */
+    size_t drainEvents( EncoderEvent *events, size_t maxEvents );
+
+    /**
+     * @brief Get the number of events dropped because the event queue was full.
+     *
+     */
+    uint32_t getEventOverflows() { return eventOverflows; }
+
+    /**
+     * @brief Start recording what the encoder and button pins do, edge by edge.
+     *
+     * Every time either ISR runs (bounce and edges the glitch filter rejects included), it
+     * adds one `uint32_t` to `buffer`: the pin levels it saw in the low bits (`RE_CAPTURE_A`,
+     * `RE_CAPTURE_B` and `RE_CAPTURE_BUTTON`), `RE_CAPTURE_BUTTON_ISR` if it was the
+     * button's ISR, and micros() above `RE_CAPTURE_TIME_SHIFT`.
+     * The first entry holds the levels at the start.  Once `buffer` is full, the oldest
+     * entries are overwritten, so it always holds the latest `size` of them.
+     *
+     * A capture taken on the board can be played back on the host with
+     * `RotaryEncoderHost::replay()`, to reproduce a missed or doubled detent.
+     *
+     * @note `buffer` must stay valid until `stopCapture()`.
+     * @note Only edges that interrupt are seen: with `DECODE_X2` or `DECODE_X1`, B is
+     *       only recorded along with A, and with `PCNT_BACKEND` or `SCAN_BACKEND`, only
+     *       the button is.
+     *
+     * @param buffer  Where to record
+     * @param size    Number of entries `buffer` has room for
+     */
+    void startCapture( uint32_t *buffer, size_t size );
+
+    /**
+     * @brief Stop recording, and put the entries in order, oldest first, at the start of the buffer.
+     *
+     * @return The number of entries in the buffer
+     */
+    size_t stopCapture();
+
+  #if RE_ENABLE_STATS
+    /**
+     * @brief Get a snapshot of the counters and timings collected since `begin()`
+     * (or `resetStats()`).
+     *
+     * The ISRs are timed with the CPU cycle counter, so at 240 MHz a sample of 480 means
+     * 2 microseconds; on the host, a cycle is a nanosecond.  The latency histogram shows
+     * how long turns wait to be reported, which is mostly down to `RE_LOOP_INTERVAL` or
+     * the dispatch mode.
+     *
+     * @note Only available when the library is compiled with `RE_ENABLE_STATS` set to 1
+     *       (e.g. `-DRE_ENABLE_STATS=1` in the build flags); otherwise nothing is collected
+     *       and the ISRs are exactly as they would be without it.
+     *
+     * @return A copy of the statistics, taken all at once
+     */
+    EncoderStats getStats();
+
+    /**
+     * @brief Zero the counters and timings.
+     *
+     */
+    void resetStats();
+  #endif
+
     /**
      * @brief Sets up the GPIO pins specified in the constructor and attaches the ISR callback for the encoder.
      *
      * @note Call this in `setup()` after other "set" methods.
      *
+     * @param useTimer  true (default) to run `loop()` from a timer, false to call `loop()` yourself
+     * @param backend   ISR_BACKEND (default) to decode the knob in an interrupt on every edge;
+     *                  PCNT_BACKEND to let the pulse counter peripheral do it without interrupts
+     *                  (falls back to ISR_BACKEND if the chip or core doesn't support it);
+     *                  SCAN_BACKEND to attach no interrupts to A and B, and have them sampled
+     *                  by `RotaryEncoderManager::scan()` instead (the encoder must be `add()`ed)
      */
-    void begin( bool useTimer = true );
+    void begin( bool useTimer = true, EncoderBackend backend = ISR_BACKEND );
 
     /**
      * @brief Enables the encoder knob and pushbutton if `disable()` was previously used.
@@ -223,7 +795,7 @@ class RotaryEncoder {
      * @brief Override the value tracked by the encoder.
      *
      * @note If the new value is outside the minimum or maximum configured
-     * by `setBoundaries()`, it will be adjusted accordingly
+     * by `setBoundaries()`, it will be clamped to that boundary
      *
      * @param newValue
      */
@@ -239,6 +811,73 @@ class RotaryEncoder {
      */
     void resetEncoderValue() { setEncoderValue( 0 ); }
 
+    /**
+     * @brief Set how many steps make one full turn of the knob, for `getPosition()`.
+     *
+     * Steps are counted in the decode mode (see `setDecodeMode()`), so a knob with
+     * 20 detents of 4 steps has 80 counts per revolution in X4, 40 in X2 and 20 in X1.
+     *
+     * @param counts  Steps per revolution; 0 (default) to not count revolutions
+     */
+    void setCountsPerRevolution( uint32_t counts );
+
+    /**
+     * @brief Get the raw position of the knob.
+     *
+     * Unlike the value, the position is never stepped by more than one (no acceleration),
+     * clamped or wrapped: it counts every quadrature step since `begin()` in a 64-bit
+     * counter, which is what's needed to track travel or angle rather than a setting.
+     *
+     * The count and its timestamp always belong together; this never disables interrupts,
+     * and only retries (briefly) if the ISR updated the position while it was being read.
+     *
+     * @note With `PCNT_BACKEND`, the position is brought up to date by this call, and the
+     *       timestamp is when that happened.
+     *
+     * @return The position
+     */
+    EncoderPosition getPosition();
+
+    /**
+     * @brief Set the raw position back to 0, e.g. once a home switch is reached.
+     *
+     * @param count  Optional; the position to start counting from instead, e.g. where the
+     *               home switch is, or a position saved before the last power-down
+     */
+    void resetPosition( int64_t count = 0 );
+
+    /**
+     * @brief Set how long the knob can sit still before `getVelocity()` says it stopped.
+     *
+     * Between steps, the velocity falls off as if the next step were just about to
+     * happen, and drops to 0 once no step has come for this long.  The slowest speed
+     * that can be measured is one step per timeout.
+     *
+     * @param milliseconds  The timeout (default `RE_VELOCITY_TIMEOUT_MS`)
+     */
+    void setVelocityTimeout( uint32_t milliseconds );
+
+    /**
+     * @brief Get how fast the knob is turning, in steps per second.
+     *
+     * The ISR keeps a running average of the time between steps (weighted 1/2^`RE_VELOCITY_SMOOTHING`
+     * toward the newest), in fixed point, which costs a few instructions per edge; the
+     * division into a speed only happens here.  The average starts over whenever the
+     * direction changes or the knob was still for longer than the timeout.
+     *
+     * @note Steps are counted in the decode mode, as with `getPosition()`.
+     *
+     * @return Steps per second; positive when turning right, negative when turning left, 0 when still
+     */
+    float getVelocity();
+
+    /**
+     * @brief Get how fast the knob is turning, in revolutions per minute.
+     *
+     * @return The same as `getVelocity()`, scaled by `setCountsPerRevolution()`; 0 if that wasn't set
+     */
+    float getRPM();
+
     /**
      * @brief Synchronizes the encoder value and button state from ISRs.
      *
@@ -254,8 +893,11 @@ class RotaryEncoder {
 
     const char *LOG_TAG = "ESP32RotaryEncoder";
 
-    EncoderCallback callbackEncoderChanged = NULL;
-    ButtonCallback callbackButtonPressed = NULL;
+    EncoderCallback callbackEncoderChanged;
+    TurnCallback callbackTurnDetailed;
+    ButtonCallback callbackButtonPressed;
+    EventCallback callbackEvent;
+    GestureCallback callbackGesture;
 
     typedef enum {
         LEFT  = -1,
@@ -278,6 +920,42 @@ class RotaryEncoder {
     int8_t encoderPinButton;
     int8_t encoderPinVcc;
     uint8_t encoderTripPoint;
+    uint8_t decodeTripPoint;  // `encoderTripPoint` scaled to the decode mode; set in `begin()`
+
+    EncoderBackend backend = ISR_BACKEND;
+    DecodeMode decodeMode = DECODE_X4;
+    DispatchMode dispatchMode = DISPATCH_TIMER;
+
+    /**
+     * @brief How long the dispatcher task waits for more to happen before running `loop()`.
+     *
+     * Set in `setCoalesceWindow()`.
+     *
+     */
+    volatile uint32_t coalesceWindow = 0;
+
+    /**
+     * @brief Minimum microseconds between edges accepted by `_encoder_ISR()`, and the
+     * number of edges and transitions it has rejected.
+     *
+     * Set in `setGlitchFilter()`.
+     *
+     */
+    uint32_t glitchFilter = 0;
+    volatile uint32_t rejectedEdges = 0;
+    volatile uint32_t invalidTransitions = 0;
+
+    /**
+     * @brief Whether `_encoder_ISR()` reads A and B from one GPIO register snapshot.
+     *
+     * Requested with `setFastRead()`, but only turned on in `begin()` if both
+     * pins live in the same bank, which is when the fields below are filled in.
+     *
+     */
+    bool fastRead = false;
+    uint32_t gpioInputRegister;
+    uint8_t gpioShiftA;
+    uint8_t gpioShiftB;
 
     /**
      * @brief Determines whether knob turns or button presses will be ignored.  ISRs still fire,
@@ -302,6 +980,24 @@ class RotaryEncoder {
      */
     long stepValue = 1;
 
+    /**
+     * @brief The acceleration profile and its multipliers, set in `setAcceleration()`
+     * or `setAccelerationTable()`, and the step for each speed bucket built from them
+     * by `buildAccelerationTable()`, which is what `_encoder_ISR()` uses.
+     *
+     */
+    AccelerationProfile accelerationProfile = ACCEL_DEFAULT;
+    uint16_t accelerationMultipliers[RE_ACCEL_BUCKETS];
+    long accelerationSteps[RE_ACCEL_BUCKETS];
+
+    /**
+     * @brief log2 of the number of detents averaged for acceleration.
+     *
+     * Set in `setAccelerationSmoothing()`.
+     *
+     */
+    uint8_t accelerationSmoothing = 0;
+
     /**
      * @brief Determines whether attempts to increment or decrement beyond
      * the boundaries causes `currentValue` to wrap to the other boundary.
@@ -314,31 +1010,284 @@ class RotaryEncoder {
     /**
      * @brief The value tracked by `encoder_ISR()` when the encoder knob is turned.
      *
-     * This value can be overwritten in `constrainValue()` whenever
-     * `getEncoderValue()` or `setEncoderValue()` are called.
+     * Atomic so that readers never have to hold `mux` (and hold off the ISRs) to get it.
+     * Only ever written through `addToValue()` and `setEncoderValue()`, which both keep
+     * it within the boundaries.
+     *
+     */
+    std::atomic<long> currentValue;
+
+    /**
+     * @brief Counts how many times `encoder_ISR()` changed `currentValue` and how many
+     * times `button_ISR()` saw the button released.
+     *
+     * `encoderChanged()` and `buttonPressed()` compare these with the counts they saw
+     * last time, so the ISRs only ever increment them and nothing needs a lock.
+     *
+     */
+    std::atomic<uint32_t> encoderChanges, buttonReleases;
+    std::atomic<uint32_t> encoderChangesSeen, buttonReleasesSeen;
+
+    /**
+     * @brief When the button went down (only used by `button_ISR()`), and how long it
+     * was held the last time it was released.
+     *
+     */
+    volatile unsigned long buttonPressedTime;  // micros()
+    std::atomic<unsigned long> buttonPressedDuration;
+
+    /**
+     * @brief Working state of the quadrature decoder and the button de-bounce.
+     *
+     * Only touched by `_encoder_ISR()` and `_button_ISR()` (and reset in `begin()`).
+     * This is per-instance so that every encoder has its own state machine, and it's
+     * kept small and together so the ISRs only have to touch a few bytes of memory.
+     *
+     */
+    typedef struct {
+      uint8_t previousAB = 3;             // Last two A/B samples, 2 bits each
+      int8_t encoderPosition = 0;         // Steps taken since the last detent
+      int8_t lastRotation = STILL;        // Direction of the last valid step, to recover skipped ones
+      unsigned long lastEdgeTime = 0;     // micros() of the last accepted edge, for the glitch filter
+      unsigned long lastDetentTime = 0;   // micros() of the last detent, for acceleration
+      unsigned long lastButtonTime = 0;   // micros() of the last button edge, for de-bounce
+      bool buttonDown = false;            // De-bounced state of the button
+      uint8_t intervalIndex = 0;          // Next slot in `intervals`
+      uint32_t intervalSum = 0;           // Sum of the last 2^`accelerationSmoothing` intervals
+      uint32_t intervals[RE_ACCEL_SMOOTHING_MAX];  // Recent times between detents
+    } ISRState;
+
+    ISRState isrState;
+
+    /**
+     * @brief The raw position for `getPosition()`, and the step timing for `getVelocity()`.
+     *
+     */
+    typedef struct {
+      int64_t count = 0;                  // Steps since `begin()` or `resetPosition()`
+      uint32_t time = 0;                  // micros() of the last step
+      uint32_t period = 0;                // Average microseconds per step, in 1/2^RE_VELOCITY_FRACTION; 0 when stopped
+      int8_t direction = STILL;           // Direction of the last step
+      uint32_t detents = 0;               // Detents since `begin()`, for `onTurnedDetailed()`
+      uint32_t detentTime = 0;            // micros() of the last detent
+      int8_t detentDirection = STILL;     // Direction of the last detent, which steps since then don't change
+      uint32_t detentInterval = 0;        // Microseconds between the last two detents; 0 after a stop
+    } PositionState;
+
+    /**
+     * @brief Only written with `mux` held, through `addToPosition()` and `resetPosition()`.
+     *
+     * A 64-bit count can't be written in one go on a 32-bit core, so the writer makes
+     * `positionSequence` odd while it updates `positionState`, and even again when done
+     * (a sequence lock); `readPosition()` retries until it saw the same even sequence
+     * before and after copying, which means it got a consistent copy.
+     *
+     */
+    std::atomic<uint32_t> positionSequence { 0 };
+    PositionState positionState;
+    uint32_t countsPerRevolution = 0;
+    uint32_t velocityTimeout = RE_VELOCITY_TIMEOUT_MS * 1000UL;  // Microseconds
+
+    /**
+     * @brief Adds to the raw position and folds the time since the last step into
+     * the average step period; called with `mux` held.
+     *
+     * @param now      micros() when it happened
+     * @param detents  How many detents these steps completed
+     */
+    void ARDUINO_ISR_ATTR addToPosition( int64_t steps, unsigned long now, uint32_t detents = 0 );
+
+    /**
+     * @brief Gets a consistent copy of `positionState` without taking `mux`.
+     *
+     */
+    PositionState readPosition();
+
+    /**
+     * @brief The policy set by `setTurnedPolicy()` (times in milliseconds), and where
+     * `loop()` is at with it; only touched by `loop()`.
+     *
+     */
+    uint32_t turnMinInterval = 0;
+    long turnMinDelta = 0;
+    uint32_t turnSettleTime = 0;
+    bool turnLeading = true;
+    bool turnTrailing = true;
+    bool turnPending = false;         // A change is being held back
+    bool turnWindowOpen = false;      // A rate-limit interval started at `turnWindowStart`
+    uint32_t turnWindowStart = 0;     // millis()
+    uint32_t lastTurnTime = 0;        // millis() when `loop()` last saw the value change
+    long reportedValue = 0;           // The value last passed to `onTurned()`
+    uint32_t reportedDetents = 0;     // `PositionState::detents` as of the last call
+
+    /**
+     * @brief Whether the policy lets `loop()` report a held-back change now.
+     *
+     */
+    bool turnDue( uint32_t now, long value );
+
+    /**
+     * @brief How long until the settle time or the rate limit lets a held-back change
+     * through, in milliseconds; 0 if neither is holding it back.
+     *
+     */
+    uint32_t turnWait( uint32_t now );
+
+    /**
+     * @brief How long the dispatcher task may sleep before a held-back change comes due,
+     * or before it may go idle.
+     *
+     * @return Ticks, or portMAX_DELAY if there's nothing to wake up for
+     */
+    TickType_t dispatchWait();
+
+    /**
+     * @brief `encoderChanged()` without the statistics and logging, for `loop()`, which
+     * counts a change as reported only once the policy lets the callbacks have it.
+     *
+     */
+    bool takeEncoderChange();
+
+    /**
+     * @brief The settings from `setLowPower()`.  `lowPowerIdle` is set by `loop()` when it
+     * goes idle and cleared by the first ISR after that, which sets `wakePending` for
+     * `finishWakeUp()` to clear; `vccReleased` is only touched by `loop()`.
+     *
+     */
+    uint32_t idleTimeout = 0;             // Milliseconds; 0 to never go idle
+    bool idleSwitchVcc = false;
+    volatile bool lowPowerIdle = false;
+    volatile bool wakePending = false;
+    bool vccReleased = false;
+
+    /**
+     * @brief How long until `loop()` may go idle, in milliseconds; 0 if it may now.
+     *
+     */
+    uint32_t idleRemaining();
+
+    /**
+     * @brief Stops the loop timer, releases Vcc if asked to, and sets up the wake sources.
+     *
+     */
+    void enterIdle();
+
+    /**
+     * @brief Powers the encoder through `encoderPinVcc` again, and puts the pin modes back.
+     *
+     */
+    void restorePower();
+
+    /**
+     * @brief Makes the pins `attachInterrupts()` uses light-sleep wake sources, or puts
+     * their edge interrupts back, through the GPIO driver; never called from an ISR.
+     *
+     */
+    void setWakeSources( bool enable );
+    void setWakeSource( uint8_t pin, bool enable, gpio_int_type_t edges );
+
+    /**
+     * @brief Puts the edge interrupt types of those pins back by writing the GPIO registers
+     * directly, which is all an ISR can do; called with `mux` held.
+     *
+     */
+    void ARDUINO_ISR_ATTR setEdgeInterrupts();
+
+    /**
+     * @brief Leaves the idle state; called by the ISRs when `lowPowerIdle` is set.
+     *
+     * Only stops the wake sources from interrupting on their level, and hands the rest to
+     * `finishWakeUp()`: through the dispatcher task, or with `DISPATCH_TIMER`, through the
+     * FreeRTOS timer task, since the loop timer is stopped.
      *
      */
-    volatile long currentValue;
+    void ARDUINO_ISR_ATTR wakeUp();
 
     /**
-     * @brief Becomes `true` when `encoder_ISR()` changes `currentValue`,
-     * then becomes `false` when caught by `loop()` via `encoderChanged()`
+     * @brief Finishes what `wakeUp()` started, in a task: turns the wake sources off in the
+     * GPIO driver and starts the loop timer again.  Does nothing unless `wakePending` is set.
      *
      */
-    volatile bool encoderChangedFlag;
+    void finishWakeUp();
+    static void finishWakeUpCallback( void *instance, uint32_t /* unused */ );
 
     /**
-     * @brief Becomes `true` when `button_ISR()` changes `currentValue`,
-     * then becomes `false` when caught by `loop()` via `buttonPressed()`
+     * @brief Single-producer/single-consumer ring of events; see `setEventQueue()`.
+     *
+     * The ISRs (which are serialized by `mux`) only ever advance `eventHead`, and
+     * the consumer only ever advances `eventTail`, so neither side needs a lock.
      *
      */
-    volatile bool buttonPressedFlag;
+    bool eventQueueEnabled = false;
+    EncoderEvent eventQueue[RE_EVENT_QUEUE_SIZE];
+    std::atomic<uint32_t> eventHead { 0 };
+    std::atomic<uint32_t> eventTail { 0 };
+    volatile uint32_t eventOverflows = 0;
 
     /**
-     * @brief
+     * @brief The buffer given to `startCapture()` (NULL when not capturing), how many
+     * entries were recorded into it, and the button level last recorded.
      *
      */
-    volatile unsigned long buttonPressedTime, buttonPressedDuration;
+    uint32_t *captureBuffer = NULL;
+    size_t captureSize = 0;
+    uint32_t captureCount = 0;
+    uint8_t captureButton = RE_CAPTURE_BUTTON;
+
+    /**
+     * @brief Adds an entry to the capture buffer; called with `mux` held.
+     *
+     * @param now   micros() when it happened
+     * @param pins  The RE_CAPTURE_ bits of the pins that are HIGH, and of the ISR
+     */
+    void ARDUINO_ISR_ATTR recordCapture( unsigned long now, uint8_t pins );
+
+    #if RE_ENABLE_STATS
+      /**
+       * @brief What `getStats()` returns, only updated with `mux` held.
+       *
+       * `statsPendingDetents` counts detents not yet reported (see `recordReport()`),
+       * and `statsFirstDetent` is the micros() of the first of them.
+       *
+       */
+      EncoderStats stats = {};
+      uint32_t statsPendingDetents = 0;
+      unsigned long statsFirstDetent = 0;
+
+      /**
+       * @brief Adds a sample to one of the histograms in `stats`; called with `mux` held.
+       *
+       */
+      static void ARDUINO_ISR_ATTR recordSample( EncoderHistogram &histogram, uint32_t value );
+
+      /**
+       * @brief Counts `detents` new detents decoded at `now`; called with `mux` held.
+       *
+       */
+      void ARDUINO_ISR_ATTR recordDetents( uint32_t detents, unsigned long now );
+
+      /**
+       * @brief Counts a report of the pending detents, where the application gets it:
+       * `encoderChanged()` returning true, or `loop()` calling the turn callbacks.
+       *
+       */
+      void recordReport();
+    #endif
+
+    #if defined( RE_HAS_PCNT )
+      /**
+       * @brief The pulse counter unit and channels used by the PCNT backend.
+       *
+       * `counterLast` is the count as of the last `pollCounter()`, and `counterRemainder`
+       * holds counts that haven't added up to a whole detent yet.
+       *
+       */
+      pcnt_unit_handle_t counterUnit = NULL;
+      pcnt_channel_handle_t counterChannelA = NULL;
+      pcnt_channel_handle_t counterChannelB = NULL;
+      int counterLast = 0;
+      int counterRemainder = 0;
+    #endif
 
     /**
      * @brief The loop timer configured and started in `beginLoopTimer()`.
@@ -346,14 +1295,89 @@ class RotaryEncoder {
      * This replaces the need to run the class loop in userspace `loop()`.
      *
      */
-    esp_timer_handle_t loopTimer;
+    esp_timer_handle_t loopTimer = NULL;
 
     /**
-     * @brief Constrains the value set by `encoder_ISR()` and `setEncoderValue()`
+     * @brief The dispatcher task created in `beginDispatchTask()`, which the ISRs notify.
+     *
+     */
+    TaskHandle_t dispatchTask = NULL;
+
+    /**
+     * @brief Whether `dispatchTask` was created by this instance (rather than being
+     * the shared task of `RotaryEncoderManager`), and whether the manager knows about
+     * this instance at all.
+     *
+     */
+    bool dispatchTaskOwned = false;
+    bool managed = false;
+
+    /**
+     * @brief Fills `accelerationSteps` from the multipliers and the step value.
+     *
+     * Called with `mux` held whenever either changes.
+     *
+     */
+    void buildAccelerationTable();
+
+    /**
+     * @brief Forgets the recent detent intervals, as if the knob had been still for a while.
+     *
+     * Called with `mux` held in `begin()` and `setAccelerationSmoothing()`.
+     *
+     */
+    void resetIntervals();
+
+    /**
+     * @brief Constrains a value set by `encoder_ISR()` or `setEncoderValue()`
      * to be in the range set by `setBoundaries()`.
      *
+     * Out-of-range values are either clamped, or (with circular boundaries) wrapped
+     * around modulo the size of the range, so a step that overshoots by more than the
+     * whole range still lands where it should.
+     *
+     * @return The value within the boundaries
+     */
+    long ARDUINO_ISR_ATTR constrainValue( int64_t value ) const;
+
+    /**
+     * @brief Adds to `currentValue` and constrains the result before storing it,
+     * so `currentValue` is never outside the boundaries.
+     *
+     * @return The new value
+     */
+    long ARDUINO_ISR_ATTR addToValue( long delta );
+
+    /**
+     * @brief Works out which GPIO input register and bits hold the A and B pins.
+     *
+     * Called in `begin()` when `setFastRead()` was used.
+     *
+     */
+    void configureFastRead();
+
+    /**
+     * @brief The GPIO number of a pin, which is what picks its bit out of a GPIO input register.
+     *
+     */
+    static int8_t gpioNumber( uint8_t pin );
+
+    /**
+     * @brief Reads pin A (bit 1) and pin B (bit 0), from the register snapshot if `fastRead` is on.
+     *
      */
-    void constrainValue();
+    inline uint8_t ARDUINO_ISR_ATTR readAB()
+    {
+      if( fastRead )
+      {
+        // Both pins from the same instant, with a single register read
+        uint32_t gpioInput = REG_READ( gpioInputRegister );
+
+        return ( ( ( gpioInput >> gpioShiftA ) & 0x01 ) << 1 ) | ( ( gpioInput >> gpioShiftB ) & 0x01 );
+      }
+
+      return ( digitalRead( encoderPinA ) ? 0x02 : 0 ) | ( digitalRead( encoderPinB ) ? 0x01 : 0 );
+    }
 
     /**
      * @brief Attaches ISRs to encoder and button pins.
@@ -371,6 +1395,32 @@ class RotaryEncoder {
      */
     void detachInterrupts();
 
+    /**
+     * @brief Sets up the pulse counter unit and channels for the PCNT backend and starts counting.
+     *
+     * Called in `begin()`.
+     *
+     * @return false if the counter could not be set up
+     */
+    bool beginCounter();
+
+    /**
+     * @brief Stops the pulse counter and releases the unit and channels.
+     *
+     * Used in the destructor, and in `beginCounter()` to clean up after a failure.
+     *
+     */
+    void endCounter();
+
+    /**
+     * @brief Turns counts accumulated by the pulse counter into detents.
+     *
+     * This is where the PCNT backend does what `_encoder_ISR()` does for the ISR backend.
+     * Called by `encoderChanged()` and `getEncoderValue()`.
+     *
+     */
+    void pollCounter();
+
     /**
      * @brief Sets up the loop timer and starts it.
      *
@@ -393,11 +1443,134 @@ class RotaryEncoder {
       instance->loop();
     }
 
+    /**
+     * @brief How the button is de-bounced, and the timer that waits for it to settle
+     * with `DEBOUNCE_INTEGRATING`.
+     *
+     * Set in `setButtonDebounce()`; the timer is created in `begin()`.
+     *
+     */
+    uint32_t debounceTime = RE_DEBOUNCE_US;
+    DebounceMode debounceMode = DEBOUNCE_LOCKOUT;
+    esp_timer_handle_t debounceTimer = NULL;
+
+    /**
+     * @brief Acts on a de-bounced button edge; called with `mux` held.
+     *
+     * @return true if `loop()` has something to report
+     */
+    bool ARDUINO_ISR_ATTR buttonEdge( bool isPressed, unsigned long now );
+
+    /**
+     * @brief Body of `debounceTimer`; the button has been still for the debounce time.
+     *
+     * Static for the same reason as `timerCallback()`.
+     *
+     * @param arg
+     */
+    static void debounceTimerCallback( void *arg );
+
+    /**
+     * @brief Where the button gesture state machine is at.
+     *
+     */
+    typedef enum {
+      GESTURE_IDLE,
+      GESTURE_PRESSED,        // Down; waiting to see if it's a long press
+      GESTURE_HELD,           // Long press reported; repeating until released
+      GESTURE_RELEASED,       // Clicked once; waiting to see if it's a double-click
+      GESTURE_SECOND_PRESS    // Down again within the double-click time
+    } GestureState;
+
+    /**
+     * @brief The button gesture state machine, fed by `_button_ISR()` through `gestureEdge()`
+     * and by `gestureTimer` through `gestureTimeout()`, all with `mux` held.
+     *
+     * `gesturesPending` has a bit per ButtonGesture still to be reported, and
+     * `gestureDeadline` is the `esp_timer_get_time()` at which the current state times
+     * out (0 for never).
+     *
+     */
+    esp_timer_handle_t gestureTimer = NULL;
+    uint32_t longPressTime = RE_LONG_PRESS_MS * 1000UL;      // Microseconds
+    uint32_t doubleClickTime = RE_DOUBLE_CLICK_MS * 1000UL;  // Microseconds
+    uint32_t repeatTime = RE_REPEAT_MS * 1000UL;             // Microseconds
+    GestureState gestureState = GESTURE_IDLE;
+    uint8_t gesturesPending = 0;
+    int64_t gestureDeadline = 0;
+
+    /**
+     * @brief Advances the gesture state machine on a button edge.
+     *
+     */
+    void ARDUINO_ISR_ATTR gestureEdge( bool isPressed, int64_t now );
+
+    /**
+     * @brief (Re-)arms `gestureTimer` for whatever the state machine needs next:
+     * right away if a gesture is pending, at the deadline if there is one, or not at all.
+     *
+     */
+    void ARDUINO_ISR_ATTR armGestureTimer( int64_t now );
+
+    /**
+     * @brief Body of `gestureTimer`; reports pending gestures and handles timeouts.
+     *
+     * Static for the same reason as `timerCallback()`.
+     *
+     * @param arg
+     */
+    static void gestureTimerCallback( void *arg );
+
+    /**
+     * @brief Creates the dispatcher task.
+     *
+     * Called in `begin()` instead of `beginLoopTimer()` when using `DISPATCH_NOTIFY`.
+     *
+     */
+    void beginDispatchTask();
+
+    /**
+     * @brief Body of the dispatcher task; sleeps until notified by an ISR, then runs `loop()`.
+     *
+     * Static for the same reason as `timerCallback()`.
+     *
+     * @param arg
+     */
+    static void dispatchTaskFunction( void *arg );
+
+    /**
+     * @brief Wakes the dispatcher task, if there is one.
+     *
+     * Called by the ISRs after leaving their critical section.
+     *
+     */
+    void ARDUINO_ISR_ATTR notifyDispatcher();
+
+    /**
+     * @brief Adds an event to the event queue, or counts it as an overflow if it's full.
+     *
+     * Only called from the ISRs, and only when the event queue is enabled.
+     *
+     * @param timestamp  micros() when it happened
+     */
+    void ARDUINO_ISR_ATTR pushEvent( EncoderEventType type, long value, uint32_t timestamp );
+
+    /**
+     * @brief Decodes a new sample of A and B; the part of `_encoder_ISR()` that
+     * `RotaryEncoderManager::scan()` shares.  Called with `mux` held.
+     *
+     * @param ab   Pin A in bit 1, pin B in bit 0
+     * @param now  micros() when the pins were sampled
+     *
+     * @return true if the value changed, and `loop()` has something to report
+     */
+    bool ARDUINO_ISR_ATTR processTransition( uint8_t ab, unsigned long now );
+
     /**
      * @brief Interrupt Service Routine for the encoder.
      *
-     * Detects direction of knob turn and increments/decrements `currentValue`, and sets
-     * the `encoderChangedFlag` to be picked up by `encoderChanged()` in `_loop()`.
+     * Detects direction of knob turn and increments/decrements `currentValue`, and
+     * counts the change in `encoderChanges` to be picked up by `encoderChanged()` in `_loop()`.
      *
      */
     void ARDUINO_ISR_ATTR _encoder_ISR();
@@ -405,10 +1578,13 @@ class RotaryEncoder {
     /**
      * @brief Interrupt Service Routine for the pushbutton.
      *
-     * Sets the `buttonPressedFlag` to be picked up by `buttonPressed()` in `_loop()`.
+     * Counts releases in `buttonReleases` to be picked up by `buttonPressed()` in `_loop()`.
      *
      */
     void ARDUINO_ISR_ATTR _button_ISR();
 };
 
+#include "RotaryEncoderManager.h"
+#include "RotaryEncoderT.h"
+
 #endif
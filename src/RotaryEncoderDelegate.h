@@ -0,0 +1,104 @@
+#ifndef _RotaryEncoderDelegate_h
+#define _RotaryEncoderDelegate_h
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef RE_DELEGATE_SIZE
+  #define RE_DELEGATE_SIZE ( 3 * sizeof( void * ) )  // Largest callable a delegate can hold
+#endif
+
+template<typename Signature>
+class RotaryEncoderDelegate;
+
+/**
+ * @brief A callback holder that never allocates.
+ *
+ * Works like a `std::function`, but the callable (a plain function, or a lambda
+ * with a few captures) is copied into `RE_DELEGATE_SIZE` bytes inside the delegate
+ * itself, and calling it is a single indirect call.  Anything bigger, or anything
+ * that needs a destructor (like a `std::function` or a `std::string` capture),
+ * is rejected at compile time.
+ *
+ * ```c++
+ * rotaryEncoder.onTurned( &knobCallback );
+ * rotaryEncoder.onTurned( [this]( long value ){ volume = value; } );
+ * ```
+ *
+ */
+template<typename R, typename... Args>
+class RotaryEncoderDelegate<R( Args... )> {
+
+  public:
+
+    RotaryEncoderDelegate() {}
+
+    RotaryEncoderDelegate( std::nullptr_t ) {}
+
+    template<typename F, typename = typename std::enable_if<
+      !std::is_same<typename std::decay<F>::type, RotaryEncoderDelegate>::value &&
+      !std::is_same<typename std::decay<F>::type, std::nullptr_t>::value
+    >::type>
+    RotaryEncoderDelegate( F f )
+    {
+      typedef typename std::decay<F>::type Callable;
+
+      static_assert( sizeof( Callable ) <= sizeof( storage ), "Callback is too big; capture less, or raise RE_DELEGATE_SIZE" );
+      static_assert( alignof( Callable ) <= alignof( std::max_align_t ), "Callback has unsupported alignment" );
+      static_assert( std::is_trivially_copyable<Callable>::value && std::is_trivially_destructible<Callable>::value,
+        "Callback must be a function or a lambda capturing only pointers and plain values" );
+
+      if( isNull( f ) )
+        return;
+
+      new( &storage ) Callable( f );
+      invoker = &invoke<Callable>;
+    }
+
+    R operator()( Args... args ) const
+    {
+      return invoker( &storage, std::forward<Args>( args )... );
+    }
+
+    explicit operator bool() const
+    {
+      return invoker != nullptr;
+    }
+
+  private:
+
+    alignas( std::max_align_t ) mutable unsigned char storage[RE_DELEGATE_SIZE];
+    R (*invoker)( void *, Args... ) = nullptr;
+
+    template<typename Callable>
+    static R invoke( void *callable, Args... args )
+    {
+      return ( *static_cast<Callable *>( callable ) )( std::forward<Args>( args )... );
+    }
+
+    template<typename T>
+    static bool isNull( T *pointer ) { return pointer == nullptr; }
+
+    template<typename T>
+    static bool isNull( const T & ) { return false; }
+};
+
+/**
+ * @brief Adapts a member function to the `void (*)( void * )` that `attachInterruptArg()`
+ * takes, with the object as the argument, so an interrupt goes straight to the member
+ * function without `std::bind` or anything on the heap.
+ *
+ * ```c++
+ * attachInterruptArg( pin, rotaryEncoderThunk<RotaryEncoder, &RotaryEncoder::_encoder_ISR>, this, CHANGE );
+ * ```
+ *
+ */
+template<typename T, void ( T::*Method )()>
+void ARDUINO_ISR_ATTR rotaryEncoderThunk( void *object )
+{
+  ( static_cast<T *>( object )->*Method )();
+}
+
+#endif
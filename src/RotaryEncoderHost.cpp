@@ -0,0 +1,1199 @@
+#if defined( RE_HOST_BUILD )
+
+#include "RotaryEncoderHost.h"
+#include "ESP32RotaryEncoder.h"
+
+#include <chrono>
+#include <vector>
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void *arg;
+  const char *name;
+  uint64_t period;
+  uint64_t expiry;
+  bool active;
+};
+
+struct pcnt_chan_t;
+
+struct pcnt_unit_t {
+  int count;
+  bool enabled;
+  bool running;
+  std::vector<pcnt_chan_t *> channels;
+};
+
+struct pcnt_chan_t {
+  pcnt_unit_t *unit;
+  int edgePin;
+  int levelPin;
+  pcnt_channel_edge_action_t positiveEdge;
+  pcnt_channel_edge_action_t negativeEdge;
+  pcnt_channel_level_action_t highLevel;
+  pcnt_channel_level_action_t lowLevel;
+};
+
+struct HostTask {
+  TaskFunction_t function;
+  void *arg;
+  std::thread thread;
+  uint32_t notifications = 0;
+  uint64_t wakeTime = UINT64_MAX;
+  bool started = false;
+  bool waitingNotify = false;
+  bool running = false;
+  bool finished = false;
+  bool deleted = false;
+};
+
+// Thrown inside a task's thread to unwind it when the task is deleted
+struct HostTaskDeleted {};
+
+typedef struct {
+  uint8_t level = HIGH;
+  uint8_t mode = INPUT;
+  int interruptMode = 0;
+  bool wakeup = false;
+  bool pending = false;
+  std::function<void(void)> handler;
+  void (*handlerArg)( void * ) = nullptr;
+  void *arg = nullptr;
+} HostPin;
+
+static HostPin hostPins[RE_HOST_PIN_COUNT];
+static std::vector<esp_timer *> hostTimers;
+static std::vector<pcnt_unit_t *> hostCounters;
+static uint64_t hostClock = 0;
+static uint32_t hostInterrupts = 0;
+static uint32_t hostTimerCallbacks = 0;
+static uint32_t hostTaskWakes = 0;
+static uint32_t hostWakeups = 0;
+static uint8_t hostBounceEdges = 0;
+static uint32_t hostBounceSpacing = 0;
+static uint8_t hostEdgeLoss = 0;
+static uint32_t hostInterruptLatency = 0;
+static uint64_t hostBusyUntil = 0;
+static uint32_t hostRandom = 1;
+static bool hostInterruptsMasked = false;
+static bool hostInISR = false;
+static uint32_t hostISRDriverCalls = 0;
+
+// Calls pended to the timer task by `xTimerPendFunctionCallFromISR()`
+typedef struct {
+  PendedFunction_t function;
+  void *parameter1;
+  uint32_t parameter2;
+} HostPendedCall;
+
+static std::vector<HostPendedCall> hostPendedCalls;
+static HostLockHold hostLockHold[2] = {};
+
+// Never destroyed, so tasks still blocked at exit don't wait on a dead mutex
+static std::vector<HostTask *> &hostTasks = *new std::vector<HostTask *>();
+static std::mutex &hostTaskMutex = *new std::mutex();
+static std::condition_variable &hostTaskSignal = *new std::condition_variable();
+static thread_local HostTask *hostCurrentTask = NULL;
+
+
+/**
+ * Time
+ */
+
+unsigned long millis()
+{
+  return (unsigned long)( hostClock / 1000 );
+}
+
+unsigned long micros()
+{
+  return (unsigned long)hostClock;
+}
+
+void delay( uint32_t ms )
+{
+  RotaryEncoderHost::advance( (uint64_t)ms * 1000 );
+}
+
+void delayMicroseconds( uint32_t us )
+{
+  RotaryEncoderHost::advance( us );
+}
+
+int64_t esp_timer_get_time()
+{
+  return (int64_t)hostClock;
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+/**
+ * Critical sections
+ */
+
+static int64_t hostNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void hostEnterCritical( portMUX_TYPE *mux )
+{
+  mux->lock.lock();
+
+  if( mux->depth++ == 0 )
+    mux->enteredNs = hostNanoseconds();
+}
+
+void hostExitCritical( portMUX_TYPE *mux )
+{
+  if( --mux->depth == 0 )
+  {
+    int64_t held = hostNanoseconds() - mux->enteredNs;
+    HostLockHold &hold = hostLockHold[hostInISR ? 1 : 0];
+
+    hold.count++;
+    hold.totalNs += held;
+
+    if( held > hold.maxNs )
+      hold.maxNs = (uint32_t)held;
+  }
+
+  mux->lock.unlock();
+}
+
+
+/**
+ * GPIO and interrupts
+ */
+
+void pinMode( uint8_t pin, uint8_t mode )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return;
+
+  hostPins[pin].mode = mode;
+}
+
+int digitalRead( uint8_t pin )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return LOW;
+
+  return hostPins[pin].level;
+}
+
+void digitalWrite( uint8_t pin, uint8_t val )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return;
+
+  hostPins[pin].level = val ? HIGH : LOW;
+}
+
+void attachInterrupt( uint8_t pin, std::function<void(void)> intRoutine, int mode )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return;
+
+  hostPins[pin].handler = intRoutine;
+  hostPins[pin].handlerArg = nullptr;
+  hostPins[pin].interruptMode = mode;
+}
+
+void attachInterruptArg( uint8_t pin, void (*userFunc)( void * ), void *arg, int mode )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return;
+
+  hostPins[pin].handler = nullptr;
+  hostPins[pin].handlerArg = userFunc;
+  hostPins[pin].arg = arg;
+  hostPins[pin].interruptMode = mode;
+}
+
+void detachInterrupt( uint8_t pin )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return;
+
+  hostPins[pin].handler = nullptr;
+  hostPins[pin].handlerArg = nullptr;
+  hostPins[pin].interruptMode = 0;
+}
+
+
+esp_err_t gpio_set_intr_type( gpio_num_t gpio_num, gpio_int_type_t intr_type )
+{
+  if( hostInISR )
+    hostISRDriverCalls++;
+
+  if( gpio_num < 0 || gpio_num >= RE_HOST_PIN_COUNT )
+    return ESP_ERR_INVALID_ARG;
+
+  hostPins[gpio_num].interruptMode = intr_type;
+
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable( gpio_num_t gpio_num, gpio_int_type_t intr_type )
+{
+  if( hostInISR )
+    hostISRDriverCalls++;
+
+  if( gpio_num < 0 || gpio_num >= RE_HOST_PIN_COUNT )
+    return ESP_ERR_INVALID_ARG;
+
+  if( intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL )
+    return ESP_ERR_INVALID_ARG;
+
+  // As on hardware, this replaces the pin's interrupt type
+  hostPins[gpio_num].interruptMode = intr_type;
+  hostPins[gpio_num].wakeup = true;
+
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable( gpio_num_t gpio_num )
+{
+  if( hostInISR )
+    hostISRDriverCalls++;
+
+  if( gpio_num < 0 || gpio_num >= RE_HOST_PIN_COUNT )
+    return ESP_ERR_INVALID_ARG;
+
+  hostPins[gpio_num].wakeup = false;
+
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup()
+{
+  return ESP_OK;
+}
+
+struct gpio_dev_t {};
+gpio_dev_t GPIO;
+
+void gpio_ll_set_intr_type( gpio_dev_t * /* hw */, uint32_t gpio_num, gpio_int_type_t intr_type )
+{
+  if( gpio_num >= RE_HOST_PIN_COUNT )
+    return;
+
+  hostPins[gpio_num].interruptMode = intr_type;
+}
+
+
+/**
+ * FreeRTOS tasks
+ */
+
+static bool taskIsReady( HostTask *task )
+{
+  if( task->finished || task->running )
+    return false;
+
+  return !task->started
+      || ( task->waitingNotify && task->notifications > 0 )
+      || ( task->wakeTime <= hostClock );
+}
+
+// Called by a task, with `lock` held, to hand control back until the scheduler picks it again
+static void taskBlock( std::unique_lock<std::mutex> &lock, HostTask *task )
+{
+  task->running = false;
+  hostTaskSignal.notify_all();
+
+  hostTaskSignal.wait( lock, [task]{ return task->running || task->deleted; } );
+
+  if( task->deleted )
+    throw HostTaskDeleted();
+}
+
+static void taskMain( HostTask *task )
+{
+  hostCurrentTask = task;
+
+  {
+    std::unique_lock<std::mutex> lock( hostTaskMutex );
+    hostTaskSignal.wait( lock, [task]{ return task->running || task->deleted; } );
+
+    if( task->deleted )
+      return;
+  }
+
+  try
+  {
+    task->function( task->arg );
+  }
+  catch( HostTaskDeleted & )
+  {
+  }
+
+  std::lock_guard<std::mutex> lock( hostTaskMutex );
+  task->finished = true;
+  task->running = false;
+  hostTaskSignal.notify_all();
+}
+
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char * /* pcName */, uint32_t /* usStackDepth */, void *pvParameters, UBaseType_t /* uxPriority */, TaskHandle_t *pxCreatedTask )
+{
+  HostTask *task = new HostTask();
+  task->function = pxTaskCode;
+  task->arg = pvParameters;
+
+  {
+    std::lock_guard<std::mutex> lock( hostTaskMutex );
+    hostTasks.push_back( task );
+  }
+
+  task->thread = std::thread( taskMain, task );
+
+  if( pxCreatedTask != NULL )
+    *pxCreatedTask = task;
+
+  RotaryEncoderHost::settle();
+
+  return pdPASS;
+}
+
+void vTaskDelete( TaskHandle_t xTaskToDelete )
+{
+  HostTask *task = ( xTaskToDelete == NULL ) ? hostCurrentTask : xTaskToDelete;
+
+  if( task == NULL )
+    return;
+
+  if( task == hostCurrentTask )
+  {
+    std::lock_guard<std::mutex> lock( hostTaskMutex );
+    task->deleted = true;
+    throw HostTaskDeleted();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( hostTaskMutex );
+
+    task->deleted = true;
+    hostTaskSignal.notify_all();
+
+    for( size_t i = 0; i < hostTasks.size(); i++ )
+    {
+      if( hostTasks[i] == task )
+      {
+        hostTasks.erase( hostTasks.begin() + i );
+        break;
+      }
+    }
+  }
+
+  task->thread.join();
+  delete task;
+}
+
+void vTaskDelay( TickType_t xTicksToDelay )
+{
+  HostTask *task = hostCurrentTask;
+
+  if( task == NULL )
+  {
+    RotaryEncoderHost::advance( (uint64_t)xTicksToDelay * 1000 );
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock( hostTaskMutex );
+
+  task->waitingNotify = false;
+  task->wakeTime = hostClock + (uint64_t)xTicksToDelay * 1000;
+  taskBlock( lock, task );
+  task->wakeTime = UINT64_MAX;
+}
+
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+{
+  HostTask *task = hostCurrentTask;
+
+  if( task == NULL )
+    return 0;
+
+  std::unique_lock<std::mutex> lock( hostTaskMutex );
+
+  if( task->notifications == 0 && xTicksToWait > 0 )
+  {
+    task->waitingNotify = true;
+    task->wakeTime = ( xTicksToWait == portMAX_DELAY ) ? UINT64_MAX : hostClock + (uint64_t)xTicksToWait * 1000;
+    taskBlock( lock, task );
+    task->waitingNotify = false;
+    task->wakeTime = UINT64_MAX;
+  }
+
+  uint32_t count = task->notifications;
+
+  if( count > 0 )
+    task->notifications = xClearCountOnExit ? 0 : count - 1;
+
+  return count;
+}
+
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify )
+{
+  vTaskNotifyGiveFromISR( xTaskToNotify, NULL );
+
+  if( hostCurrentTask == NULL )
+    RotaryEncoderHost::settle();
+
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+{
+  if( xTaskToNotify == NULL )
+    return;
+
+  std::lock_guard<std::mutex> lock( hostTaskMutex );
+  xTaskToNotify->notifications++;
+
+  if( pxHigherPriorityTaskWoken != NULL )
+    *pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  return hostCurrentTask;
+}
+
+BaseType_t xTimerPendFunctionCallFromISR( PendedFunction_t xFunctionToPend, void *pvParameter1, uint32_t ulParameter2, BaseType_t *pxHigherPriorityTaskWoken )
+{
+  hostPendedCalls.push_back( { xFunctionToPend, pvParameter1, ulParameter2 } );
+
+  if( pxHigherPriorityTaskWoken != NULL )
+    *pxHigherPriorityTaskWoken = pdTRUE;
+
+  return pdPASS;
+}
+
+
+/**
+ * Pulse counter
+ */
+
+esp_err_t pcnt_new_unit( const pcnt_unit_config_t *config, pcnt_unit_handle_t *ret_unit )
+{
+  if( config == NULL || ret_unit == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  pcnt_unit_t *unit = new pcnt_unit_t();
+  hostCounters.push_back( unit );
+  *ret_unit = unit;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_del_unit( pcnt_unit_handle_t unit )
+{
+  if( unit == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  if( unit->enabled || !unit->channels.empty() )
+    return ESP_ERR_INVALID_STATE;
+
+  for( size_t i = 0; i < hostCounters.size(); i++ )
+  {
+    if( hostCounters[i] == unit )
+    {
+      hostCounters.erase( hostCounters.begin() + i );
+      break;
+    }
+  }
+
+  delete unit;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_set_glitch_filter( pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t * /* config */ )
+{
+  return ( unit == NULL ) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t pcnt_unit_add_watch_point( pcnt_unit_handle_t unit, int /* watch_point */ )
+{
+  return ( unit == NULL ) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t pcnt_unit_enable( pcnt_unit_handle_t unit )
+{
+  if( unit == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  unit->enabled = true;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_disable( pcnt_unit_handle_t unit )
+{
+  if( unit == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  unit->enabled = false;
+  unit->running = false;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_start( pcnt_unit_handle_t unit )
+{
+  if( unit == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  if( !unit->enabled )
+    return ESP_ERR_INVALID_STATE;
+
+  unit->running = true;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_stop( pcnt_unit_handle_t unit )
+{
+  if( unit == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  unit->running = false;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_clear_count( pcnt_unit_handle_t unit )
+{
+  if( unit == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  unit->count = 0;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_get_count( pcnt_unit_handle_t unit, int *value )
+{
+  if( unit == NULL || value == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  *value = unit->count;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_new_channel( pcnt_unit_handle_t unit, const pcnt_chan_config_t *config, pcnt_channel_handle_t *ret_chan )
+{
+  if( unit == NULL || config == NULL || ret_chan == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  pcnt_chan_t *channel = new pcnt_chan_t();
+  channel->unit = unit;
+  channel->edgePin = config->edge_gpio_num;
+  channel->levelPin = config->level_gpio_num;
+
+  unit->channels.push_back( channel );
+  *ret_chan = channel;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_del_channel( pcnt_channel_handle_t chan )
+{
+  if( chan == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  std::vector<pcnt_chan_t *> &channels = chan->unit->channels;
+
+  for( size_t i = 0; i < channels.size(); i++ )
+  {
+    if( channels[i] == chan )
+    {
+      channels.erase( channels.begin() + i );
+      break;
+    }
+  }
+
+  delete chan;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_channel_set_edge_action( pcnt_channel_handle_t chan, pcnt_channel_edge_action_t pos_act, pcnt_channel_edge_action_t neg_act )
+{
+  if( chan == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  chan->positiveEdge = pos_act;
+  chan->negativeEdge = neg_act;
+
+  return ESP_OK;
+}
+
+esp_err_t pcnt_channel_set_level_action( pcnt_channel_handle_t chan, pcnt_channel_level_action_t high_act, pcnt_channel_level_action_t low_act )
+{
+  if( chan == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  chan->highLevel = high_act;
+  chan->lowLevel = low_act;
+
+  return ESP_OK;
+}
+
+static void runInterrupt( HostPin &p )
+{
+  hostInterrupts++;
+
+  hostInISR = true;
+
+  if( p.handlerArg )
+    p.handlerArg( p.arg );
+  else
+    p.handler();
+
+  hostInISR = false;
+
+  // The timer task runs what the ISR pended before anything else gets a turn
+  while( !hostPendedCalls.empty() )
+  {
+    HostPendedCall call = hostPendedCalls.front();
+    hostPendedCalls.erase( hostPendedCalls.begin() );
+
+    hostTaskWakes++;
+    call.function( call.parameter1, call.parameter2 );
+  }
+
+  RotaryEncoderHost::settle();
+}
+
+// Runs an ISR that's due, and keeps the CPU busy with it as set by `setInterruptLatency()`
+static void serviceInterrupt( HostPin &p )
+{
+  runInterrupt( p );
+
+  hostBusyUntil = hostClock + hostInterruptLatency;
+}
+
+static bool anyPending()
+{
+  for( size_t i = 0; i < RE_HOST_PIN_COUNT; i++ )
+    if( hostPins[i].pending )
+      return true;
+
+  return false;
+}
+
+// Runs the ISRs of edges latched while the CPU was busy, once it no longer is
+static void servicePending()
+{
+  for( size_t i = 0; i < RE_HOST_PIN_COUNT && hostClock >= hostBusyUntil; i++ )
+  {
+    HostPin &p = hostPins[i];
+
+    if( !p.pending )
+      continue;
+
+    p.pending = false;
+
+    if( p.handler || p.handlerArg )
+      serviceInterrupt( p );
+  }
+}
+
+static void countEdge( uint8_t pin, uint8_t level )
+{
+  for( pcnt_unit_t *unit : hostCounters )
+  {
+    if( !unit->running )
+      continue;
+
+    for( pcnt_chan_t *channel : unit->channels )
+    {
+      if( channel->edgePin != pin )
+        continue;
+
+      pcnt_channel_edge_action_t edge = level ? channel->positiveEdge : channel->negativeEdge;
+      pcnt_channel_level_action_t modifier = hostPins[channel->levelPin].level ? channel->highLevel : channel->lowLevel;
+
+      if( edge == PCNT_CHANNEL_EDGE_ACTION_HOLD || modifier == PCNT_CHANNEL_LEVEL_ACTION_HOLD )
+        continue;
+
+      int step = ( edge == PCNT_CHANNEL_EDGE_ACTION_INCREASE ) ? 1 : -1;
+
+      if( modifier == PCNT_CHANNEL_LEVEL_ACTION_INVERSE )
+        step = -step;
+
+      unit->count += step;
+    }
+  }
+}
+
+
+/**
+ * esp_timer
+ */
+
+esp_err_t esp_timer_create( const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle )
+{
+  if( create_args == NULL || create_args->callback == NULL || out_handle == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  esp_timer *timer = new esp_timer();
+  timer->callback = create_args->callback;
+  timer->arg = create_args->arg;
+  timer->name = create_args->name;
+
+  hostTimers.push_back( timer );
+  *out_handle = timer;
+
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once( esp_timer_handle_t timer, uint64_t timeout_us )
+{
+  if( timer == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  if( timer->active )
+    return ESP_ERR_INVALID_STATE;
+
+  timer->period = 0;
+  timer->expiry = hostClock + timeout_us;
+  timer->active = true;
+
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic( esp_timer_handle_t timer, uint64_t period )
+{
+  if( hostInISR )
+    hostISRDriverCalls++;
+
+  if( timer == NULL || period == 0 )
+    return ESP_ERR_INVALID_ARG;
+
+  if( timer->active )
+    return ESP_ERR_INVALID_STATE;
+
+  timer->period = period;
+  timer->expiry = hostClock + period;
+  timer->active = true;
+
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop( esp_timer_handle_t timer )
+{
+  if( timer == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  if( !timer->active )
+    return ESP_ERR_INVALID_STATE;
+
+  timer->active = false;
+
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete( esp_timer_handle_t timer )
+{
+  if( timer == NULL )
+    return ESP_ERR_INVALID_ARG;
+
+  if( timer->active )
+    return ESP_ERR_INVALID_STATE;
+
+  for( size_t i = 0; i < hostTimers.size(); i++ )
+  {
+    if( hostTimers[i] == timer )
+    {
+      hostTimers.erase( hostTimers.begin() + i );
+      break;
+    }
+  }
+
+  delete timer;
+
+  return ESP_OK;
+}
+
+
+/**
+ * Simulation control
+ */
+
+void RotaryEncoderHost::reset()
+{
+  for( size_t i = 0; i < RE_HOST_PIN_COUNT; i++ )
+  {
+    hostPins[i].level = HIGH;
+    hostPins[i].mode = INPUT;
+    hostPins[i].interruptMode = 0;
+    hostPins[i].wakeup = false;
+    hostPins[i].pending = false;
+    hostPins[i].handlerArg = nullptr;
+    hostPins[i].handler = nullptr;
+  }
+
+  while( !hostTasks.empty() )
+    vTaskDelete( hostTasks.back() );
+
+  for( esp_timer *timer : hostTimers )
+    delete timer;
+
+  hostTimers.clear();
+
+  for( pcnt_unit_t *unit : hostCounters )
+  {
+    for( pcnt_chan_t *channel : unit->channels )
+      delete channel;
+
+    delete unit;
+  }
+
+  hostCounters.clear();
+
+  hostClock = 0;
+  hostInterrupts = 0;
+  hostLockHold[0] = {};
+  hostLockHold[1] = {};
+  hostISRDriverCalls = 0;
+  hostPendedCalls.clear();
+  hostBounceEdges = 0;
+  hostBounceSpacing = 0;
+  hostEdgeLoss = 0;
+  hostInterruptLatency = 0;
+  hostBusyUntil = 0;
+  hostRandom = 1;
+  hostTimerCallbacks = 0;
+  hostTaskWakes = 0;
+  hostWakeups = 0;
+}
+
+void RotaryEncoderHost::setPin( uint8_t pin, uint8_t level )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return;
+
+  HostPin &p = hostPins[pin];
+
+  level = level ? HIGH : LOW;
+
+  // Whatever was latched before this edge gets its turn first
+  servicePending();
+
+  if( p.level == level )
+    return;
+
+  p.level = level;
+
+  countEdge( pin, level );
+
+  if( !p.handler && !p.handlerArg )
+    return;
+
+  // Level interrupts only fire once per change here, where hardware keeps firing until the ISR deals with it
+  bool fire = ( p.interruptMode == CHANGE )
+           || ( ( p.interruptMode == RISING  || p.interruptMode == GPIO_INTR_HIGH_LEVEL ) && level == HIGH )
+           || ( ( p.interruptMode == FALLING || p.interruptMode == GPIO_INTR_LOW_LEVEL  ) && level == LOW  );
+
+  if( !fire || hostInterruptsMasked )
+    return;
+
+  // Only a level interrupt wakes the chip; a wake source already back on its edges is just awake
+  if( p.wakeup && ( p.interruptMode == GPIO_INTR_LOW_LEVEL || p.interruptMode == GPIO_INTR_HIGH_LEVEL ) )
+    hostWakeups++;
+
+  // Still busy with another ISR; this one waits, merged with any other edge on the pin
+  if( hostClock < hostBusyUntil )
+  {
+    p.pending = true;
+    return;
+  }
+
+  serviceInterrupt( p );
+}
+
+uint8_t RotaryEncoderHost::getPin( uint8_t pin )
+{
+  if( pin >= RE_HOST_PIN_COUNT )
+    return LOW;
+
+  return hostPins[pin].level;
+}
+
+void RotaryEncoderHost::advance( uint64_t us )
+{
+  uint64_t target = hostClock + us;
+
+  for( ;; )
+  {
+    // Find the earliest timer that comes due on or before the target
+    esp_timer *next = NULL;
+
+    for( esp_timer *timer : hostTimers )
+      if( timer->active && timer->expiry <= target && ( next == NULL || timer->expiry < next->expiry ) )
+        next = timer;
+
+    // ...and the earliest task delay that ends before that
+    uint64_t wakeTime = UINT64_MAX;
+
+    {
+      std::lock_guard<std::mutex> lock( hostTaskMutex );
+
+      for( HostTask *task : hostTasks )
+        if( !task->finished && task->wakeTime < wakeTime )
+          wakeTime = task->wakeTime;
+    }
+
+    // Edges latched while an ISR kept the CPU busy are serviced as soon as it's free
+    if( hostBusyUntil <= target && hostBusyUntil < wakeTime && ( next == NULL || hostBusyUntil < next->expiry ) && anyPending() )
+    {
+      if( hostClock < hostBusyUntil )
+        hostClock = hostBusyUntil;
+
+      servicePending();
+      continue;
+    }
+
+    if( wakeTime <= target && ( next == NULL || wakeTime < next->expiry ) )
+    {
+      hostWakeups++;
+      hostClock = wakeTime;
+      settle();
+      continue;
+    }
+
+    if( next == NULL )
+      break;
+
+    hostClock = next->expiry;
+
+    if( next->period )
+      next->expiry += next->period;
+    else
+      next->active = false;
+
+    hostTimerCallbacks++;
+    hostWakeups++;
+    next->callback( next->arg );
+
+    settle();
+  }
+
+  hostClock = target;
+
+  servicePending();
+}
+
+uint64_t RotaryEncoderHost::now()
+{
+  return hostClock;
+}
+
+void RotaryEncoderHost::turn( uint8_t pinA, uint8_t pinB, long steps, uint32_t stepInterval )
+{
+  // Gray code sequence of A/B when turning right; left is the same sequence in reverse
+  static const uint8_t sequence[4] = { 0b11, 0b01, 0b00, 0b10 };
+
+  uint8_t ab = ( getPin( pinA ) << 1 ) | getPin( pinB );
+
+  uint8_t index = 0;
+  while( sequence[index] != ab )
+    index++;
+
+  int8_t direction = ( steps < 0 ) ? 3 : 1;
+  unsigned long count = ( steps < 0 ) ? -steps : steps;
+
+  for( unsigned long i = 0; i < count; i++ )
+  {
+    advance( stepInterval );
+
+    index = ( index + direction ) & 0x03;
+    ab = sequence[index];
+
+    // Only one pin changes per step
+    uint8_t pin = ( ( ab & 0x02 ) >> 1 != getPin( pinA ) ) ? pinA : pinB;
+    uint8_t level = ( pin == pinA ) ? ( ab & 0x02 ) : ( ab & 0x01 );
+
+    // A lost edge changes the pin without its ISR ever running
+    hostInterruptsMasked = hostEdgeLoss > 0 && nextRandom() % 100 < hostEdgeLoss;
+    setPin( pin, level );
+    hostInterruptsMasked = false;
+
+    for( uint8_t bounce = 0; bounce < hostBounceEdges; bounce++ )
+    {
+      advance( hostBounceSpacing );
+      setPin( pin, !level );
+      advance( hostBounceSpacing );
+      setPin( pin, level );
+    }
+  }
+}
+
+void RotaryEncoderHost::setButton( uint8_t pin, bool pressed )
+{
+  uint8_t level = pressed ? LOW : HIGH;
+
+  setPin( pin, level );
+
+  for( uint8_t bounce = 0; bounce < hostBounceEdges; bounce++ )
+  {
+    advance( hostBounceSpacing );
+    setPin( pin, !level );
+    advance( hostBounceSpacing );
+    setPin( pin, level );
+  }
+}
+
+void RotaryEncoderHost::setBounce( uint8_t edges, uint32_t spacing )
+{
+  hostBounceEdges = edges;
+  hostBounceSpacing = spacing;
+}
+
+void RotaryEncoderHost::setEdgeLoss( uint8_t percent )
+{
+  hostEdgeLoss = percent;
+}
+
+void RotaryEncoderHost::setInterruptLatency( uint32_t us )
+{
+  hostInterruptLatency = us;
+}
+
+uint64_t RotaryEncoderHost::replay( const uint32_t *trace, size_t count, uint8_t pinA, uint8_t pinB, int8_t pinButton )
+{
+  uint64_t start = hostClock;
+
+  for( size_t i = 0; i < count; i++ )
+  {
+    uint32_t entry = trace[i];
+
+    if( i > 0 )
+    {
+      // The timestamps wrap around at 2^28, so the difference has to as well
+      uint32_t elapsed = ( entry >> RE_CAPTURE_TIME_SHIFT ) - ( trace[i - 1] >> RE_CAPTURE_TIME_SHIFT );
+
+      advance( elapsed & ( 0xFFFFFFFFUL >> RE_CAPTURE_TIME_SHIFT ) );
+    }
+
+    // Each entry is one run of an ISR, whatever the pins did (or seemed to do) before
+    // it, so change the levels without interrupts and then run that ISR once
+    hostInterruptsMasked = true;
+
+    setPin( pinA, ( entry & RE_CAPTURE_A ) ? HIGH : LOW );
+    setPin( pinB, ( entry & RE_CAPTURE_B ) ? HIGH : LOW );
+
+    if( pinButton >= 0 )
+      setPin( pinButton, ( entry & RE_CAPTURE_BUTTON ) ? HIGH : LOW );
+
+    hostInterruptsMasked = false;
+
+    // The first entry is where the pins were when the capture started
+    if( i == 0 )
+      continue;
+
+    int8_t pin = ( entry & RE_CAPTURE_BUTTON_ISR ) ? pinButton : pinA;
+
+    if( pin >= 0 && ( hostPins[pin].handler || hostPins[pin].handlerArg ) )
+      runInterrupt( hostPins[pin] );
+  }
+
+  return hostClock - start;
+}
+
+uint32_t RotaryEncoderHost::nextRandom()
+{
+  // xorshift32; deterministic so that runs can be compared
+  hostRandom ^= hostRandom << 13;
+  hostRandom ^= hostRandom >> 17;
+  hostRandom ^= hostRandom << 5;
+
+  return hostRandom;
+}
+
+uint32_t RotaryEncoderHost::readRegister( uint32_t reg )
+{
+  uint8_t first = ( reg == GPIO_IN1_REG ) ? 32 : 0;
+  uint32_t value = 0;
+
+  for( uint8_t bit = 0; bit < 32 && first + bit < RE_HOST_PIN_COUNT; bit++ )
+    value |= (uint32_t)hostPins[first + bit].level << bit;
+
+  return value;
+}
+
+void RotaryEncoderHost::settle()
+{
+  // Tasks don't schedule each other; only the harness does
+  if( hostCurrentTask != NULL )
+    return;
+
+  std::unique_lock<std::mutex> lock( hostTaskMutex );
+
+  for( ;; )
+  {
+    HostTask *next = NULL;
+
+    for( HostTask *task : hostTasks )
+    {
+      if( taskIsReady( task ) )
+      {
+        next = task;
+        break;
+      }
+    }
+
+    if( next == NULL )
+      break;
+
+    next->started = true;
+    next->running = true;
+    hostTaskWakes++;
+    hostTaskSignal.notify_all();
+
+    hostTaskSignal.wait( lock, [next]{ return !next->running; } );
+  }
+}
+
+uint32_t RotaryEncoderHost::interruptCount()
+{
+  return hostInterrupts;
+}
+
+uint32_t RotaryEncoderHost::timerCount()
+{
+  return hostTimerCallbacks;
+}
+
+uint32_t RotaryEncoderHost::taskWakeCount()
+{
+  return hostTaskWakes;
+}
+
+uint32_t RotaryEncoderHost::wakeupCount()
+{
+  return hostWakeups;
+}
+
+HostLockHold RotaryEncoderHost::lockHold( bool inISR )
+{
+  return hostLockHold[inISR ? 1 : 0];
+}
+
+uint32_t RotaryEncoderHost::isrDriverCallCount()
+{
+  return hostISRDriverCalls;
+}
+
+#endif
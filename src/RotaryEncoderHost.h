@@ -0,0 +1,517 @@
+#ifndef _RotaryEncoderHost_h
+#define _RotaryEncoderHost_h
+
+/**
+ * Host-side (Linux) backend for ESP32RotaryEncoder.
+ *
+ * Compile the library natively with `RE_HOST_BUILD` defined and this header stands in for
+ * the small part of the Arduino-ESP32 core and ESP-IDF that the library relies on: GPIO,
+ * interrupts, time, `esp_timer`, critical sections and logging.
+ *
+ * Nothing here runs on its own.  Pin levels and time are simulated, and a harness drives
+ * them through the `RotaryEncoderHost` class at the bottom of this file -- for example,
+ * `turn()` plays a quadrature waveform into the encoder pins (firing the attached ISRs
+ * exactly like the GPIO peripheral would), and `advance()` moves the clock forward and
+ * fires any `esp_timer` that comes due along the way.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#define IRAM_ATTR
+#define ARDUINO_ISR_ATTR
+
+#define LOW   0x0
+#define HIGH  0x1
+
+#define INPUT         0x01
+#define OUTPUT        0x03
+#define PULLUP        0x04
+#define INPUT_PULLUP  0x05
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define constrain( amt, low, high ) ( ( amt ) < ( low ) ? ( low ) : ( ( amt ) > ( high ) ? ( high ) : ( amt ) ) )
+
+#define RE_HOST_PIN_COUNT 64
+
+
+/**
+ * Logging; mirrors the levels of esp32-hal-log.h and honors `CORE_DEBUG_LEVEL` the same way
+ */
+
+#ifndef CORE_DEBUG_LEVEL
+  #define CORE_DEBUG_LEVEL 0
+#endif
+
+#define RE_HOST_LOG( level, letter, tag, format, ... ) \
+  do { if( CORE_DEBUG_LEVEL >= level ) fprintf( stderr, letter " (%s) " format "\n", tag, ##__VA_ARGS__ ); } while( 0 )
+
+#define ESP_LOGE( tag, format, ... ) RE_HOST_LOG( 1, "E", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGW( tag, format, ... ) RE_HOST_LOG( 2, "W", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGI( tag, format, ... ) RE_HOST_LOG( 3, "I", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGD( tag, format, ... ) RE_HOST_LOG( 4, "D", tag, format, ##__VA_ARGS__ )
+#define ESP_LOGV( tag, format, ... ) RE_HOST_LOG( 5, "V", tag, format, ##__VA_ARGS__ )
+
+#define ESP_EARLY_LOGE ESP_LOGE
+#define ESP_EARLY_LOGW ESP_LOGW
+#define ESP_EARLY_LOGI ESP_LOGI
+#define ESP_EARLY_LOGD ESP_LOGD
+#define ESP_EARLY_LOGV ESP_LOGV
+
+
+/**
+ * Critical sections; like the ESP32 spinlocks, these may be nested by the same caller.
+ * Each is timed from the outermost enter to the matching exit; see `RotaryEncoderHost::lockHold()`.
+ */
+
+typedef struct {
+  std::recursive_mutex lock;
+  uint32_t depth;
+  int64_t enteredNs;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+void hostEnterCritical( portMUX_TYPE *mux );
+void hostExitCritical( portMUX_TYPE *mux );
+
+#define portENTER_CRITICAL( mux )     hostEnterCritical( mux )
+#define portEXIT_CRITICAL( mux )      hostExitCritical( mux )
+#define portENTER_CRITICAL_ISR( mux ) hostEnterCritical( mux )
+#define portEXIT_CRITICAL_ISR( mux )  hostExitCritical( mux )
+
+
+/**
+ * Error codes (subset of esp_err.h)
+ */
+
+typedef int esp_err_t;
+
+#define ESP_OK                 0
+#define ESP_FAIL              -1
+#define ESP_ERR_NO_MEM         0x101
+#define ESP_ERR_INVALID_ARG    0x102
+#define ESP_ERR_INVALID_STATE  0x103
+
+
+/**
+ * Time; the clock only moves when the harness calls `RotaryEncoderHost::advance()`
+ * (or when the library calls `delay()`)
+ */
+
+unsigned long millis();
+unsigned long micros();
+void delay( uint32_t ms );
+void delayMicroseconds( uint32_t us );
+
+
+/**
+ * CPU cycle counter (Esp.h); unlike the clock above this is real time, counting
+ * nanoseconds as if the CPU ran at 1 GHz, so code running on the host can be timed
+ */
+
+class EspClass {
+  public:
+    uint32_t getCycleCount();
+};
+
+extern EspClass ESP;
+
+
+/**
+ * GPIO and interrupts
+ */
+
+void pinMode( uint8_t pin, uint8_t mode );
+int digitalRead( uint8_t pin );
+void digitalWrite( uint8_t pin, uint8_t val );
+void attachInterrupt( uint8_t pin, std::function<void(void)> intRoutine, int mode );
+void attachInterruptArg( uint8_t pin, void (*userFunc)( void * ), void *arg, int mode );
+void detachInterrupt( uint8_t pin );
+
+
+/**
+ * GPIO input registers (soc/gpio_reg.h); pins 0-31 are in GPIO_IN_REG, 32-63 in GPIO_IN1_REG
+ */
+
+#define SOC_GPIO_PIN_COUNT RE_HOST_PIN_COUNT
+
+#define GPIO_IN_REG   0x3FF4403C
+#define GPIO_IN1_REG  0x3FF44040
+
+#define REG_READ( reg ) RotaryEncoderHost::readRegister( reg )
+
+
+/**
+ * Interrupt types and light-sleep wakeup (subset of driver/gpio.h, hal/gpio_ll.h and
+ * esp_sleep.h); the edge types are the same as RISING, FALLING and CHANGE.  A wake source
+ * interrupts on its level, like it does on hardware, and counts as a wakeup.  The driver
+ * functions aren't in IRAM on the board; calling them from an ISR is counted, see
+ * `RotaryEncoderHost::isrDriverCallCount()`.  `gpio_ll_set_intr_type()` is a register write,
+ * which is fine anywhere.
+ */
+
+typedef int gpio_num_t;
+
+typedef enum {
+  GPIO_INTR_DISABLE    = 0,
+  GPIO_INTR_POSEDGE    = 1,
+  GPIO_INTR_NEGEDGE    = 2,
+  GPIO_INTR_ANYEDGE    = 3,
+  GPIO_INTR_LOW_LEVEL  = 4,
+  GPIO_INTR_HIGH_LEVEL = 5
+} gpio_int_type_t;
+
+esp_err_t gpio_set_intr_type( gpio_num_t gpio_num, gpio_int_type_t intr_type );
+esp_err_t gpio_wakeup_enable( gpio_num_t gpio_num, gpio_int_type_t intr_type );
+esp_err_t gpio_wakeup_disable( gpio_num_t gpio_num );
+esp_err_t esp_sleep_enable_gpio_wakeup();
+
+typedef struct gpio_dev_t gpio_dev_t;
+extern gpio_dev_t GPIO;
+
+void gpio_ll_set_intr_type( gpio_dev_t *hw, uint32_t gpio_num, gpio_int_type_t intr_type );
+
+
+/**
+ * FreeRTOS tasks and notifications (subset of freertos/task.h)
+ *
+ * Each task gets its own thread, but they're scheduled cooperatively against the simulation:
+ * a task only runs while the harness is blocked, from the moment something makes it ready (a
+ * notification, or the clock reaching the end of a delay) until it blocks again.  That keeps
+ * runs deterministic.  Ticks are 1 ms.
+ */
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef struct HostTask *TaskHandle_t;
+typedef void (*TaskFunction_t)( void *arg );
+
+#define pdFALSE  0
+#define pdTRUE   1
+#define pdPASS   1
+#define pdFAIL   0
+
+#define portMAX_DELAY         ( (TickType_t)0xFFFFFFFF )
+#define portTICK_PERIOD_MS    1
+#define pdMS_TO_TICKS( ms )   ( (TickType_t)( ms ) )
+#define portYIELD_FROM_ISR( ... ) do {} while( 0 )
+
+BaseType_t xTaskCreate( TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask );
+void vTaskDelete( TaskHandle_t xTaskToDelete );
+void vTaskDelay( TickType_t xTicksToDelay );
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait );
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify );
+void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken );
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+
+/**
+ * Deferred calls to the FreeRTOS timer task (subset of freertos/timers.h); a call pended
+ * from an ISR runs as soon as the ISR returns, and counts as a task wake-up.
+ */
+
+typedef void (*PendedFunction_t)( void *pvParameter1, uint32_t ulParameter2 );
+
+BaseType_t xTimerPendFunctionCallFromISR( PendedFunction_t xFunctionToPend, void *pvParameter1, uint32_t ulParameter2, BaseType_t *pxHigherPriorityTaskWoken );
+
+
+/**
+ * Pulse counter (subset of driver/pulse_cnt.h); counts edges of the simulated pins as they're
+ * driven, applying the edge and level actions like the peripheral does.  Counts accumulate
+ * without limits, as with `accum_count`.  The glitch filter is accepted but not simulated.
+ */
+
+typedef struct pcnt_unit_t *pcnt_unit_handle_t;
+typedef struct pcnt_chan_t *pcnt_channel_handle_t;
+
+typedef struct {
+  int low_limit;
+  int high_limit;
+  int intr_priority;
+  struct {
+    uint32_t accum_count: 1;
+  } flags;
+} pcnt_unit_config_t;
+
+typedef struct {
+  int edge_gpio_num;
+  int level_gpio_num;
+  struct {
+    uint32_t invert_edge_input: 1;
+    uint32_t invert_level_input: 1;
+    uint32_t virt_edge_io_level: 1;
+    uint32_t virt_level_io_level: 1;
+    uint32_t io_loop_back: 1;
+  } flags;
+} pcnt_chan_config_t;
+
+typedef struct {
+  uint32_t max_glitch_ns;
+} pcnt_glitch_filter_config_t;
+
+typedef enum {
+  PCNT_CHANNEL_EDGE_ACTION_HOLD,
+  PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+  PCNT_CHANNEL_EDGE_ACTION_DECREASE
+} pcnt_channel_edge_action_t;
+
+typedef enum {
+  PCNT_CHANNEL_LEVEL_ACTION_KEEP,
+  PCNT_CHANNEL_LEVEL_ACTION_INVERSE,
+  PCNT_CHANNEL_LEVEL_ACTION_HOLD
+} pcnt_channel_level_action_t;
+
+esp_err_t pcnt_new_unit( const pcnt_unit_config_t *config, pcnt_unit_handle_t *ret_unit );
+esp_err_t pcnt_del_unit( pcnt_unit_handle_t unit );
+esp_err_t pcnt_unit_set_glitch_filter( pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t *config );
+esp_err_t pcnt_unit_add_watch_point( pcnt_unit_handle_t unit, int watch_point );
+esp_err_t pcnt_unit_enable( pcnt_unit_handle_t unit );
+esp_err_t pcnt_unit_disable( pcnt_unit_handle_t unit );
+esp_err_t pcnt_unit_start( pcnt_unit_handle_t unit );
+esp_err_t pcnt_unit_stop( pcnt_unit_handle_t unit );
+esp_err_t pcnt_unit_clear_count( pcnt_unit_handle_t unit );
+esp_err_t pcnt_unit_get_count( pcnt_unit_handle_t unit, int *value );
+esp_err_t pcnt_new_channel( pcnt_unit_handle_t unit, const pcnt_chan_config_t *config, pcnt_channel_handle_t *ret_chan );
+esp_err_t pcnt_del_channel( pcnt_channel_handle_t chan );
+esp_err_t pcnt_channel_set_edge_action( pcnt_channel_handle_t chan, pcnt_channel_edge_action_t pos_act, pcnt_channel_edge_action_t neg_act );
+esp_err_t pcnt_channel_set_level_action( pcnt_channel_handle_t chan, pcnt_channel_level_action_t high_act, pcnt_channel_level_action_t low_act );
+
+
+/**
+ * esp_timer (subset of esp_timer.h); callbacks run in the context of whoever advanced the clock
+ */
+
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)( void *arg );
+
+typedef enum {
+  ESP_TIMER_TASK,
+  ESP_TIMER_ISR
+} esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void *arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char *name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create( const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle );
+esp_err_t esp_timer_start_once( esp_timer_handle_t timer, uint64_t timeout_us );
+esp_err_t esp_timer_start_periodic( esp_timer_handle_t timer, uint64_t period );
+esp_err_t esp_timer_stop( esp_timer_handle_t timer );
+esp_err_t esp_timer_delete( esp_timer_handle_t timer );
+int64_t esp_timer_get_time();
+
+
+/**
+ * @brief How long critical sections were held, as returned by `RotaryEncoderHost::lockHold()`.
+ *
+ */
+typedef struct {
+  uint32_t count;         // Critical sections entered and left (nested ones count once)
+  uint64_t totalNs;       // Real nanoseconds they were held for, all together
+  uint32_t maxNs;         // The longest
+} HostLockHold;
+
+/**
+ * @brief Drives the simulated hardware.
+ *
+ */
+class RotaryEncoderHost {
+
+  public:
+
+    /**
+     * @brief Restore every pin to HIGH (idle, as with pull-ups), detach all interrupts,
+     * delete all timers and rewind the clock to zero.
+     *
+     */
+    static void reset();
+
+    /**
+     * @brief Drive an input pin to a level, as the outside world would.
+     *
+     * If the level changes and an interrupt is attached to the pin for that kind
+     * of edge, the ISR is called before this returns.
+     *
+     * @param pin    The pin to drive
+     * @param level  LOW or HIGH
+     */
+    static void setPin( uint8_t pin, uint8_t level );
+
+    /**
+     * @brief Get the current level of a pin.
+     *
+     * @param pin  The pin to read
+     */
+    static uint8_t getPin( uint8_t pin );
+
+    /**
+     * @brief Move the clock forward, firing any timers that come due on the way.
+     *
+     * @param us  Number of microseconds to advance
+     */
+    static void advance( uint64_t us );
+
+    /**
+     * @brief Get the current simulated time in microseconds.
+     *
+     */
+    static uint64_t now();
+
+    /**
+     * @brief Play a quadrature waveform into a pair of encoder pins.
+     *
+     * Each step flips exactly one of the two pins (Gray code), starting from whatever
+     * state they're currently in, with `stepInterval` microseconds before each step.
+     * A "detent" on most encoders is 4 steps.
+     *
+     * @param pinA          The A pin of the encoder
+     * @param pinB          The B pin of the encoder
+     * @param steps         Number of steps; positive turns right, negative turns left
+     * @param stepInterval  Microseconds between steps
+     */
+    static void turn( uint8_t pinA, uint8_t pinB, long steps, uint32_t stepInterval );
+
+    /**
+     * @brief Press or release a pushbutton (active low), bouncing as set by `setBounce()`.
+     *
+     * @param pin      The button pin
+     * @param pressed  true to press, false to release
+     */
+    static void setButton( uint8_t pin, bool pressed );
+
+    /**
+     * @brief Make every step played by `turn()` (and every `setButton()`) bounce.
+     *
+     * After each change, the pin flips back and forth `edges` more times,
+     * `spacing` microseconds apart, before settling.
+     *
+     * @param edges    Number of extra back-and-forth flips per step; 0 (default) for clean edges
+     * @param spacing  Microseconds between the flips
+     */
+    static void setBounce( uint8_t edges, uint32_t spacing );
+
+    /**
+     * @brief Make some of the steps played by `turn()` change the pin without running its ISR,
+     * as happens on hardware when edges come faster than interrupts can be serviced.
+     *
+     * The choice is pseudo-random, but the same from one `reset()` to the next.
+     *
+     * @param percent  Chance of each step being lost, 0 (default) to 100
+     */
+    static void setEdgeLoss( uint8_t percent );
+
+    /**
+     * @brief Make every ISR keep the CPU busy for a while, as it would on the board.
+     *
+     * Edges that come along meanwhile are latched, like the GPIO peripheral does, and each
+     * pin's ISR runs once when the CPU is free again, reading the pins as they are by then.
+     * Several edges on a pin in that time are one interrupt, which is how a knob spun faster
+     * than the ISR can keep up loses steps.
+     *
+     * @param us  Microseconds each ISR takes; 0 (default) for ISRs that take no time at all
+     */
+    static void setInterruptLatency( uint32_t us );
+
+    /**
+     * @brief Play back a capture recorded on the board by `RotaryEncoder::startCapture()`.
+     *
+     * The clock advances by the time between entries, the pins are set to the recorded
+     * levels, and the ISR that recorded the entry runs, so the encoder sees the same
+     * interrupts, pin levels and timing as it did on the board -- including interrupts
+     * for edges that had already gone by the time the ISR read the pins.  The first entry
+     * only sets the starting levels.  Bounce and edge loss are not applied.
+     *
+     * @param trace      The entries, oldest first, as left in the buffer by `stopCapture()`
+     * @param count      The number of entries
+     * @param pinA       The A pin of the encoder to play them into
+     * @param pinB       The B pin of the encoder
+     * @param pinButton  The button pin; -1 (default) to leave the button alone
+     *
+     * @return Microseconds of simulated time the trace took
+     */
+    static uint64_t replay( const uint32_t *trace, size_t count, uint8_t pinA, uint8_t pinB, int8_t pinButton = -1 );
+
+    /**
+     * @brief Read a GPIO input register; backs `REG_READ()`.
+     *
+     * @param reg  GPIO_IN_REG or GPIO_IN1_REG
+     */
+    static uint32_t readRegister( uint32_t reg );
+
+    /**
+     * @brief Let every task that's ready run until it blocks again.
+     *
+     * This happens by itself after every pin change and timer callback, and as
+     * `advance()` passes the end of a task's delay; harnesses rarely need it.
+     *
+     */
+    static void settle();
+
+    /**
+     * @brief Get the number of ISR calls made since `reset()`.
+     *
+     */
+    static uint32_t interruptCount();
+
+    /**
+     * @brief Get the number of timer callbacks fired since `reset()`.
+     *
+     */
+    static uint32_t timerCount();
+
+    /**
+     * @brief Get the number of times a task was woken up since `reset()`.
+     *
+     */
+    static uint32_t taskWakeCount();
+
+    /**
+     * @brief Get the number of times the chip would have had to wake from light sleep
+     * since `reset()`: every timer that fired, every task delay or timeout that ran out,
+     * and every interrupt from a pin enabled with `gpio_wakeup_enable()`.
+     *
+     * Advance the clock through an idle spell and compare, e.g. wakeups per hour with
+     * and without `RotaryEncoder::setLowPower()`.
+     *
+     */
+    static uint32_t wakeupCount();
+
+    /**
+     * @brief Get how long critical sections were held since `reset()`, in real time on
+     * this host, by ISRs or by everything else (setters, getters, `loop()`, timers, tasks).
+     *
+     * Every `portENTER_CRITICAL()` outside an ISR is time an ISR on the same core might
+     * have to wait; this is how to see how much of that the readers still cause.
+     *
+     * @param inISR  true for critical sections entered by ISRs, false for the rest
+     */
+    static HostLockHold lockHold( bool inISR );
+
+    /**
+     * @brief Get the number of calls made from an ISR since `reset()` to the GPIO driver
+     * (`gpio_set_intr_type()`, `gpio_wakeup_enable()`, `gpio_wakeup_disable()`) or to
+     * `esp_timer_start_periodic()`, none of which an ISR may call on the board.
+     *
+     */
+    static uint32_t isrDriverCallCount();
+
+  private:
+
+    static uint32_t nextRandom();
+};
+
+#endif
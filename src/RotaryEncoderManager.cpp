@@ -0,0 +1,432 @@
+#include "RotaryEncoderManager.h"
+
+static const char *LOG_TAG = "RotaryEncoderManager";
+
+RotaryEncoderManager::Entry RotaryEncoderManager::encoders[RE_MAX_ENCODERS];
+size_t RotaryEncoderManager::encoderCount = 0;
+portMUX_TYPE RotaryEncoderManager::mux = portMUX_INITIALIZER_UNLOCKED;
+esp_timer_handle_t RotaryEncoderManager::loopTimer = NULL;
+TaskHandle_t RotaryEncoderManager::dispatchTask = NULL;
+esp_timer_handle_t RotaryEncoderManager::scanTimer = NULL;
+uint32_t RotaryEncoderManager::scanMask[2] = { 0, 0 };
+uint32_t RotaryEncoderManager::scanLast[2] = { 0, 0 };
+
+bool RotaryEncoderManager::add( RotaryEncoder &encoder, uint8_t priority )
+{
+  portENTER_CRITICAL( &mux );
+
+  for( size_t i = 0; i < encoderCount; i++ )
+  {
+    if( encoders[i].encoder == &encoder )
+    {
+      portEXIT_CRITICAL( &mux );
+      return true;
+    }
+  }
+
+  if( encoderCount >= RE_MAX_ENCODERS )
+  {
+    portEXIT_CRITICAL( &mux );
+    ESP_LOGE( LOG_TAG, "Cannot add more than %i encoders", RE_MAX_ENCODERS );
+    return false;
+  }
+
+  // The lowest id no other entry has
+  uint8_t id = 0;
+  for( size_t i = 0; i < encoderCount; )
+  {
+    if( encoders[i].id == id )
+    {
+      id++;
+      i = 0;
+    }
+    else
+      i++;
+  }
+
+  // Insert after every entry of the same or higher priority
+  size_t position = encoderCount;
+  while( position > 0 && encoders[position - 1].priority < priority )
+  {
+    encoders[position] = encoders[position - 1];
+    position--;
+  }
+
+  encoders[position].encoder = &encoder;
+  encoders[position].priority = priority;
+  encoders[position].id = id;
+  encoders[position].changesSeen = encoder.encoderChanges.load( std::memory_order_acquire );
+  encoders[position].releasesSeen = encoder.buttonReleases.load( std::memory_order_acquire );
+  encoders[position].lastValue = encoder.currentValue.load( std::memory_order_relaxed );
+  encoders[position].scanned = ( encoder.backend == SCAN_BACKEND );
+  encoders[position].scanAB = encoder.isrState.previousAB & 0x03;
+
+  int8_t gpioA = RotaryEncoder::gpioNumber( encoder.encoderPinA );
+  int8_t gpioB = RotaryEncoder::gpioNumber( encoder.encoderPinB );
+
+  encoders[position].bankA = ( gpioA >= 32 ) ? 1 : 0;
+  encoders[position].shiftA = gpioA % 32;
+  encoders[position].bankB = ( gpioB >= 32 ) ? 1 : 0;
+  encoders[position].shiftB = gpioB % 32;
+
+  encoderCount++;
+
+  encoder.managed = true;
+  setDispatcher( &encoder, dispatchTask );
+  updateScanMask();
+
+  portEXIT_CRITICAL( &mux );
+
+  ESP_LOGD( LOG_TAG, "Added encoder %u with priority %u (%u total)", id, priority, (unsigned int)encoderCount );
+
+  return true;
+}
+
+void RotaryEncoderManager::remove( RotaryEncoder &encoder )
+{
+  portENTER_CRITICAL( &mux );
+
+  for( size_t i = 0; i < encoderCount; i++ )
+  {
+    if( encoders[i].encoder != &encoder )
+      continue;
+
+    for( ; i + 1 < encoderCount; i++ )
+      encoders[i] = encoders[i + 1];
+
+    encoderCount--;
+
+    encoder.managed = false;
+    setDispatcher( &encoder, NULL );
+    updateScanMask();
+
+    break;
+  }
+
+  portEXIT_CRITICAL( &mux );
+}
+
+void RotaryEncoderManager::begin( DispatchMode mode )
+{
+  if( loopTimer != NULL || dispatchTask != NULL )
+    return;
+
+  if( mode == DISPATCH_NOTIFY )
+  {
+    if( xTaskCreate( dispatchTaskFunction, "RotaryEncoderManager", RE_DISPATCH_STACK_SIZE, NULL, RE_DISPATCH_PRIORITY, &dispatchTask ) == pdPASS )
+    {
+      portENTER_CRITICAL( &mux );
+
+      for( size_t i = 0; i < encoderCount; i++ )
+        setDispatcher( encoders[i].encoder, dispatchTask );
+
+      portEXIT_CRITICAL( &mux );
+
+      ESP_LOGD( LOG_TAG, "Dispatcher task started" );
+      return;
+    }
+
+    ESP_LOGE( LOG_TAG, "Could not create dispatcher task; falling back to the loop timer" );
+    dispatchTask = NULL;
+  }
+
+  esp_timer_create_args_t _timerConfig;
+  _timerConfig.arg = NULL;
+  _timerConfig.callback = timerCallback;
+  _timerConfig.dispatch_method = ESP_TIMER_TASK;
+  _timerConfig.skip_unhandled_events = true;
+  _timerConfig.name = "RotaryEncoderManager::loop";
+
+  esp_timer_create( &_timerConfig, &loopTimer );
+  esp_timer_start_periodic( loopTimer, RE_LOOP_INTERVAL );
+
+  ESP_LOGD( LOG_TAG, "Loop timer started" );
+}
+
+void RotaryEncoderManager::end()
+{
+  if( scanTimer != NULL )
+  {
+    esp_timer_stop( scanTimer );
+    esp_timer_delete( scanTimer );
+    scanTimer = NULL;
+  }
+
+  if( loopTimer != NULL )
+  {
+    esp_timer_stop( loopTimer );
+    esp_timer_delete( loopTimer );
+    loopTimer = NULL;
+  }
+
+  if( dispatchTask != NULL )
+  {
+    portENTER_CRITICAL( &mux );
+
+    for( size_t i = 0; i < encoderCount; i++ )
+      setDispatcher( encoders[i].encoder, NULL );
+
+    portEXIT_CRITICAL( &mux );
+
+    vTaskDelete( dispatchTask );
+    dispatchTask = NULL;
+  }
+}
+
+void RotaryEncoderManager::beginScan( uint32_t interval )
+{
+  if( scanTimer != NULL )
+    return;
+
+  esp_timer_create_args_t _timerConfig;
+  _timerConfig.arg = NULL;
+  _timerConfig.callback = scanTimerCallback;
+  _timerConfig.dispatch_method = ESP_TIMER_TASK;
+  _timerConfig.skip_unhandled_events = true;
+  _timerConfig.name = "RotaryEncoderManager::scan";
+
+  if( esp_timer_create( &_timerConfig, &scanTimer ) != ESP_OK )
+  {
+    ESP_LOGE( LOG_TAG, "Could not create the scan timer" );
+    scanTimer = NULL;
+    return;
+  }
+
+  esp_timer_start_periodic( scanTimer, interval );
+
+  ESP_LOGD( LOG_TAG, "Scanning every %lu us", (unsigned long)interval );
+}
+
+void RotaryEncoderManager::scan()
+{
+  // Every scanned pin, from a single read of each GPIO input register
+  uint32_t banks[2];
+
+  banks[0] = REG_READ( GPIO_IN_REG );
+  #if SOC_GPIO_PIN_COUNT > 32
+    banks[1] = REG_READ( GPIO_IN1_REG );
+  #else
+    banks[1] = 0;
+  #endif
+
+  unsigned long now = micros();
+
+  TaskHandle_t notify[RE_MAX_ENCODERS];
+  size_t notifyCount = 0;
+
+  portENTER_CRITICAL( &mux );
+
+  // Nothing moved; one compare per register, no matter how many encoders are scanned
+  if( ( ( banks[0] ^ scanLast[0] ) & scanMask[0] ) == 0 && ( ( banks[1] ^ scanLast[1] ) & scanMask[1] ) == 0 )
+  {
+    portEXIT_CRITICAL( &mux );
+    return;
+  }
+
+  scanLast[0] = banks[0];
+  scanLast[1] = banks[1];
+
+  for( size_t i = 0; i < encoderCount; i++ )
+  {
+    Entry &entry = encoders[i];
+
+    if( !entry.scanned )
+      continue;
+
+    uint8_t ab = ( ( ( banks[entry.bankA] >> entry.shiftA ) & 0x01 ) << 1 ) | ( ( banks[entry.bankB] >> entry.shiftB ) & 0x01 );
+    uint8_t changed = ab ^ entry.scanAB;
+
+    if( changed == 0 )
+      continue;
+
+    entry.scanAB = ab;
+
+    RotaryEncoder *encoder = entry.encoder;
+
+    if( !encoder->_isEnabled )
+      continue;
+
+    // Only the edges that would have interrupted; see `RotaryEncoder::attachInterrupts()`
+    if( encoder->decodeMode == DECODE_X2 && !( changed & 0x02 ) )
+      continue;
+
+    if( encoder->decodeMode == DECODE_X1 && !( changed & ab & 0x02 ) )
+      continue;
+
+    portENTER_CRITICAL( &encoder->mux );
+    bool report = encoder->processTransition( ab, now );
+    portEXIT_CRITICAL( &encoder->mux );
+
+    if( report && encoder->dispatchTask != NULL )
+      notify[notifyCount++] = encoder->dispatchTask;
+  }
+
+  portEXIT_CRITICAL( &mux );
+
+  // Not in an ISR here, so this can't use `RotaryEncoder::notifyDispatcher()`
+  for( size_t i = 0; i < notifyCount; i++ )
+    xTaskNotifyGive( notify[i] );
+}
+
+void RotaryEncoderManager::loop()
+{
+  // Work from a copy so `add()` and `remove()` never wait on a callback
+  RotaryEncoder *snapshot[RE_MAX_ENCODERS];
+  size_t count;
+
+  portENTER_CRITICAL( &mux );
+
+  count = encoderCount;
+  for( size_t i = 0; i < count; i++ )
+    snapshot[i] = encoders[i].encoder;
+
+  portEXIT_CRITICAL( &mux );
+
+  for( size_t i = 0; i < count; i++ )
+    snapshot[i]->loop();
+}
+
+int RotaryEncoderManager::getId( RotaryEncoder &encoder )
+{
+  int id = -1;
+
+  portENTER_CRITICAL( &mux );
+
+  for( size_t i = 0; i < encoderCount; i++ )
+    if( encoders[i].encoder == &encoder )
+      id = encoders[i].id;
+
+  portEXIT_CRITICAL( &mux );
+
+  return id;
+}
+
+size_t RotaryEncoderManager::read( EncoderChange *changes, size_t maxChanges )
+{
+  // The pulse counter only turns counts into detents when asked, and that's a driver
+  // call, so it's done from a copy, before `mux` is taken
+  RotaryEncoder *snapshot[RE_MAX_ENCODERS];
+  size_t snapshotCount;
+
+  portENTER_CRITICAL( &mux );
+
+  snapshotCount = encoderCount;
+  for( size_t i = 0; i < snapshotCount; i++ )
+    snapshot[i] = encoders[i].encoder;
+
+  portEXIT_CRITICAL( &mux );
+
+  for( size_t i = 0; i < snapshotCount; i++ )
+    if( snapshot[i]->_isEnabled && snapshot[i]->backend == PCNT_BACKEND )
+      snapshot[i]->pollCounter();
+
+  size_t count = 0;
+
+  portENTER_CRITICAL( &mux );
+
+  for( size_t i = 0; i < encoderCount && count < maxChanges; i++ )
+  {
+    Entry &entry = encoders[i];
+    RotaryEncoder *encoder = entry.encoder;
+
+    if( !encoder->_isEnabled )
+      continue;
+
+    // Straight from the counters the ISRs keep, which need no lock
+    uint32_t turns = encoder->encoderChanges.load( std::memory_order_acquire );
+    uint32_t releases = encoder->buttonReleases.load( std::memory_order_acquire );
+    long value = encoder->currentValue.load( std::memory_order_relaxed );
+
+    uint8_t flags = 0;
+
+    if( turns != entry.changesSeen || value != entry.lastValue )
+      flags |= CHANGED_VALUE;
+
+    if( releases != entry.releasesSeen )
+      flags |= CHANGED_BUTTON;
+
+    if( flags == 0 )
+      continue;
+
+    EncoderChange &change = changes[count++];
+    change.id = entry.id;
+    change.flags = flags;
+    change.value = value;
+    change.delta = value - entry.lastValue;
+
+    entry.changesSeen = turns;
+    entry.releasesSeen = releases;
+    entry.lastValue = value;
+  }
+
+  portEXIT_CRITICAL( &mux );
+
+  return count;
+}
+
+void RotaryEncoderManager::setDispatcher( RotaryEncoder *encoder, TaskHandle_t task )
+{
+  // An encoder that started its own dispatcher task keeps using it
+  if( encoder->dispatchTaskOwned )
+    return;
+
+  encoder->dispatchTask = task;
+}
+
+void RotaryEncoderManager::updateScanMask()
+{
+  scanMask[0] = 0;
+  scanMask[1] = 0;
+
+  for( size_t i = 0; i < encoderCount; i++ )
+  {
+    if( !encoders[i].scanned )
+      continue;
+
+    scanMask[encoders[i].bankA] |= 1UL << encoders[i].shiftA;
+    scanMask[encoders[i].bankB] |= 1UL << encoders[i].shiftB;
+  }
+}
+
+void RotaryEncoderManager::scanTimerCallback( void * /* arg */ )
+{
+  scan();
+}
+
+void RotaryEncoderManager::timerCallback( void * /* arg */ )
+{
+  loop();
+}
+
+void RotaryEncoderManager::dispatchTaskFunction( void * /* arg */ )
+{
+  for( ;; )
+  {
+    // Asleep until an ISR has news, or until the first change held back by a policy comes due
+    TickType_t wait = portMAX_DELAY;
+
+    // `dispatchWait()` reads the clock and the position, so it runs from a copy, not under `mux`
+    RotaryEncoder *snapshot[RE_MAX_ENCODERS];
+    size_t count;
+
+    portENTER_CRITICAL( &mux );
+
+    count = encoderCount;
+    for( size_t i = 0; i < count; i++ )
+      snapshot[i] = encoders[i].encoder;
+
+    portEXIT_CRITICAL( &mux );
+
+    for( size_t i = 0; i < count; i++ )
+    {
+      TickType_t encoderWait = snapshot[i]->dispatchWait();
+
+      if( encoderWait < wait )
+        wait = encoderWait;
+    }
+
+    ulTaskNotifyTake( pdTRUE, wait );
+
+    loop();
+  }
+}
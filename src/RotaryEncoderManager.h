@@ -0,0 +1,235 @@
+#ifndef _RotaryEncoderManager_h
+#define _RotaryEncoderManager_h
+
+#include "ESP32RotaryEncoder.h"
+
+#ifndef RE_MAX_ENCODERS
+  #define RE_MAX_ENCODERS 16
+#endif
+
+#ifndef RE_SCAN_INTERVAL
+  #define RE_SCAN_INTERVAL 500U  // Microseconds between samples of SCAN_BACKEND encoders
+#endif
+
+typedef enum {
+  CHANGED_VALUE  = 0x01,  // The value changed (or the knob turned and ended up where it was)
+  CHANGED_BUTTON = 0x02   // The button was pressed and released
+} EncoderChangeFlags;
+
+/**
+ * @brief What changed on one encoder, as returned by `RotaryEncoderManager::read()`.
+ *
+ */
+typedef struct {
+  uint8_t id;             // The encoder; see `RotaryEncoderManager::getId()`
+  uint8_t flags;          // EncoderChangeFlags
+  long value;             // The value now
+  long delta;             // How much the value changed since the last `read()` that reported this encoder
+} EncoderChange;
+
+/**
+ * @brief Services any number of `RotaryEncoder` instances from a single timer or task.
+ *
+ * Normally, each `RotaryEncoder::begin()` creates its own loop timer (or dispatcher task),
+ * so a panel with eight knobs has eight timers all waking up to run `loop()`.  Instead,
+ * call `begin( false )` on each encoder, `add()` them here, then call `begin()` once.
+ *
+ * ```c++
+ * rotaryEncoder1.begin( false );
+ * rotaryEncoder2.begin( false );
+ *
+ * RotaryEncoderManager::add( rotaryEncoder1 );
+ * RotaryEncoderManager::add( rotaryEncoder2, 1 );  // Serviced before rotaryEncoder1
+ * RotaryEncoderManager::begin();
+ * ```
+ *
+ */
+class RotaryEncoderManager {
+
+  public:
+
+    /**
+     * @brief Register an encoder to be serviced.
+     *
+     * @note May be called before or after `begin()`.
+     *
+     * @param encoder   The encoder, which should have been started with `begin( false )`
+     * @param priority  Optional; encoders with a higher priority are serviced first
+     *
+     * @return false if `RE_MAX_ENCODERS` encoders are already registered
+     */
+    static bool add( RotaryEncoder &encoder, uint8_t priority = 0 );
+
+    /**
+     * @brief Stop servicing an encoder.
+     *
+     * @note This happens automatically when a registered `RotaryEncoder` is destroyed.
+     *
+     * @param encoder  The encoder
+     */
+    static void remove( RotaryEncoder &encoder );
+
+    /**
+     * @brief Start the shared loop timer (or dispatcher task).
+     *
+     * @param mode  DISPATCH_TIMER (default) to run every `RE_LOOP_INTERVAL`;
+     *              DISPATCH_NOTIFY to run only when an encoder's ISR has something to report
+     */
+    static void begin( DispatchMode mode = DISPATCH_TIMER );
+
+    /**
+     * @brief Stop the shared loop timer (or dispatcher task), and the scan timer.
+     *
+     */
+    static void end();
+
+    /**
+     * @brief Start a timer that runs `scan()` every `interval` microseconds.
+     *
+     * This is the alternative to one pair of interrupts per encoder: begin each encoder
+     * with `SCAN_BACKEND`, `add()` them here, and they're all sampled together by this
+     * one timer, however many there are.
+     *
+     * ```c++
+     * for( RotaryEncoder &knob : knobs )
+     * {
+     *   knob.begin( false, SCAN_BACKEND );
+     *   RotaryEncoderManager::add( knob );
+     * }
+     *
+     * RotaryEncoderManager::begin();
+     * RotaryEncoderManager::beginScan();
+     * ```
+     *
+     * @note Every step of the knob has to be sampled, so `interval` must be shorter than the
+     *       time between steps at the fastest turn: at the default `RE_SCAN_INTERVAL` (0.5 ms),
+     *       up to 2000 steps per second, or 500 detents per second of a 4-step encoder.
+     *
+     * @param interval  Microseconds between samples (default `RE_SCAN_INTERVAL`)
+     */
+    static void beginScan( uint32_t interval = RE_SCAN_INTERVAL );
+
+    /**
+     * @brief Sample the A and B pins of every registered `SCAN_BACKEND` encoder, and decode
+     * any that moved.
+     *
+     * Each GPIO input register is read once for all of them.  If none of their pins changed
+     * since the last scan, which is nearly always, that's all it does, whether there's one
+     * encoder or `RE_MAX_ENCODERS`; otherwise, only the encoders whose pins changed are
+     * decoded, just as their ISR would have.
+     *
+     * This is what the timer started by `beginScan()` calls; call it yourself (as often)
+     * if you have your own timer.
+     *
+     */
+    static void scan();
+
+    /**
+     * @brief Run `loop()` of every registered encoder, highest priority first.
+     *
+     * This is what the timer or task calls; call it yourself if you didn't use `begin()`.
+     *
+     */
+    static void loop();
+
+    /**
+     * @brief Get the number of registered encoders.
+     *
+     */
+    static size_t count() { return encoderCount; }
+
+    /**
+     * @brief Get the id a registered encoder is reported with by `read()`.
+     *
+     * Ids are handed out by `add()`, lowest free one first, starting at 0, and stay
+     * the same for as long as the encoder is registered.
+     *
+     * @param encoder  The encoder
+     *
+     * @return The id, or -1 if the encoder isn't registered
+     */
+    static int getId( RotaryEncoder &encoder );
+
+    /**
+     * @brief Find out what changed on all registered encoders, in one call.
+     *
+     * Instead of calling `encoderChanged()`, `getEncoderValue()` and `buttonPressed()` on
+     * each encoder (taking and releasing locks, and logging, every time), this goes over
+     * all of them at once and fills in an entry for each one that was turned or clicked
+     * since it was last reported here, highest priority first.  Encoders that didn't
+     * fit in `changes` are reported by the next call.
+     *
+     * This keeps its own track of what it has reported, so it doesn't take anything away
+     * from `loop()`; the `onTurned()` and `onPressed()` callbacks still fire as usual.
+     *
+     * ```c++
+     * EncoderChange changes[RE_MAX_ENCODERS];
+     * size_t count = RotaryEncoderManager::read( changes, RE_MAX_ENCODERS );
+     *
+     * for( size_t i = 0; i < count; i++ )
+     *   if( changes[i].flags & CHANGED_VALUE )
+     *     drawKnob( changes[i].id, changes[i].value );
+     * ```
+     *
+     * @param changes     Where to put the changes
+     * @param maxChanges  The most changes to report (size of `changes`)
+     *
+     * @return The number of changes reported
+     */
+    static size_t read( EncoderChange *changes, size_t maxChanges );
+
+  private:
+
+    typedef struct {
+      RotaryEncoder *encoder;
+      uint8_t priority;
+      uint8_t id;
+      uint32_t changesSeen;   // `encoderChanges` as of the last `read()`
+      uint32_t releasesSeen;  // `buttonReleases` as of the last `read()`
+      long lastValue;         // The value as of the last `read()`
+      bool scanned;           // Whether `scan()` samples this encoder (it uses SCAN_BACKEND)
+      uint8_t bankA, shiftA;  // Which GPIO input register, and which bit of it, holds pin A
+      uint8_t bankB, shiftB;  // ...and pin B
+      uint8_t scanAB;         // A (bit 1) and B (bit 0) as of the last `scan()`
+    } Entry;
+
+    /**
+     * @brief Registered encoders, kept sorted by descending priority.
+     *
+     */
+    static Entry encoders[RE_MAX_ENCODERS];
+    static size_t encoderCount;
+
+    static portMUX_TYPE mux;
+
+    static esp_timer_handle_t loopTimer;
+    static TaskHandle_t dispatchTask;
+
+    /**
+     * @brief The timer started by `beginScan()`, the bits of each GPIO input register that
+     * belong to scanned encoders, and those registers as of the last `scan()`.
+     *
+     */
+    static esp_timer_handle_t scanTimer;
+    static uint32_t scanMask[2];
+    static uint32_t scanLast[2];
+
+    /**
+     * @brief Rebuilds `scanMask` from the registered encoders; called with `mux` held.
+     *
+     */
+    static void updateScanMask();
+
+    static void scanTimerCallback( void *arg );
+
+    /**
+     * @brief Points an encoder's ISRs at the shared dispatcher task (or at nothing).
+     *
+     */
+    static void setDispatcher( RotaryEncoder *encoder, TaskHandle_t task );
+
+    static void timerCallback( void *arg );
+    static void dispatchTaskFunction( void *arg );
+};
+
+#endif
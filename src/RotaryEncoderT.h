@@ -0,0 +1,300 @@
+#ifndef _RotaryEncoderT_h
+#define _RotaryEncoderT_h
+
+#include "ESP32RotaryEncoder.h"
+
+/**
+ * @brief A lean `RotaryEncoder` with its pins and options fixed at compile time.
+ *
+ * The pins, steps per detent, encoder type and wrap-around behaviour are template
+ * parameters, so the trip point, GPIO register and bit masks are all constants and
+ * the ISR is a plain static function: one register read, a shift into a packed
+ * transition table, and a constant compare.  There is no acceleration; the value
+ * changes by the step value on every detent and is kept within the boundaries as
+ * it changes.
+ *
+ * ```c++
+ * RotaryEncoderT<25, 26> volumeKnob;           // GPIO 25 and 26, 4 steps, clamped
+ * RotaryEncoderT<32, 33, 2, true> menuKnob;    // GPIO 32 and 33, 2 steps, wraps around
+ *
+ * void setup()
+ * {
+ *   volumeKnob.setBoundaries( 0, 100 );
+ *   volumeKnob.onTurned( volumeChanged );
+ *   volumeKnob.begin();
+ * }
+ *
+ * void loop()
+ * {
+ *   volumeKnob.loop();
+ * }
+ * ```
+ *
+ * @note `PinA` and `PinB` are GPIO numbers, not Arduino pin numbers as with
+ * `RotaryEncoder`, since they pick bits out of the GPIO input register at compile
+ * time.  On boards with `BOARD_HAS_PIN_REMAP` (e.g. the Arduino Nano ESP32), where
+ * the two differ, give the GPIO numbers rather than the Dx pin names; `begin()` and
+ * `end()` turn them back into Arduino pins for `pinMode()` and `attachInterrupt()`.
+ *
+ * @note The state lives in static storage, one per combination of template
+ * parameters; two objects with the same parameters are the same encoder.
+ *
+ * @tparam PinA      GPIO number of the encoder's A (CLK) pin
+ * @tparam PinB      GPIO number of the encoder's B (DT) pin
+ * @tparam Steps     Steps per detent, as with `RotaryEncoder`; defaults to `RE_DEFAULT_STEPS`
+ * @tparam Circular  true to wrap from one boundary to the other; false (default) to stop at them
+ * @tparam Type      FLOATING (default) to enable the internal pull-ups; HAS_PULLUP or SW_FLOAT not to
+ */
+template<uint8_t PinA, uint8_t PinB, uint8_t Steps = RE_DEFAULT_STEPS, bool Circular = false, EncoderType Type = FLOATING>
+class RotaryEncoderT {
+
+  static_assert( PinA != PinB, "Pins A and B must be different" );
+  static_assert( PinA < SOC_GPIO_PIN_COUNT && PinB < SOC_GPIO_PIN_COUNT, "Pins A and B must be valid GPIO numbers" );
+  static_assert( Steps > 0 && Steps <= 8, "Steps per detent must be between 1 and 8" );
+
+  public:
+
+    typedef RotaryEncoderDelegate<void(long)> TurnedCallback;
+
+    /**
+     * @brief Configure the pins and attach the interrupts.
+     *
+     */
+    void begin()
+    {
+      pinMode( arduinoPin( PinA ), PinMode );
+      pinMode( arduinoPin( PinB ), PinMode );
+
+      portENTER_CRITICAL( &state.mux );
+
+      state.previousAB = readPins();
+      state.position = 0;
+
+      portEXIT_CRITICAL( &state.mux );
+
+      attachInterrupt( arduinoPin( PinA ), _encoder_ISR, CHANGE );
+      attachInterrupt( arduinoPin( PinB ), _encoder_ISR, CHANGE );
+    }
+
+    /**
+     * @brief Detach the interrupts.
+     *
+     */
+    void end()
+    {
+      detachInterrupt( arduinoPin( PinA ) );
+      detachInterrupt( arduinoPin( PinB ) );
+    }
+
+    /**
+     * @brief Set the minimum and maximum values.
+     *
+     * @param minValue  The lowest value (default -1)
+     * @param maxValue  The highest value (default 1)
+     */
+    void setBoundaries( long minValue, long maxValue )
+    {
+      if( minValue > maxValue )
+      {
+        ESP_LOGW( "RotaryEncoderT", "Minimum value (%ld) is greater than the maximum value (%ld); swapping them", minValue, maxValue );
+
+        long swap = minValue;
+        minValue = maxValue;
+        maxValue = swap;
+      }
+
+      portENTER_CRITICAL( &state.mux );
+
+      state.minValue = minValue;
+      state.maxValue = maxValue;
+      state.value = constrain( state.value, minValue, maxValue );
+
+      portEXIT_CRITICAL( &state.mux );
+    }
+
+    /**
+     * @brief Set how much the value changes per detent (default 1).
+     *
+     */
+    void setStepValue( long stepValue )
+    {
+      portENTER_CRITICAL( &state.mux );
+      state.stepValue = stepValue;
+      portEXIT_CRITICAL( &state.mux );
+    }
+
+    /**
+     * @brief Set a function to be called by `loop()` when the value has changed.
+     *
+     * @param handler  A function (or small lambda) taking the new value
+     */
+    void onTurned( TurnedCallback handler )
+    {
+      callback = handler;
+    }
+
+    /**
+     * @brief Check whether the value has changed since the last time this was called.
+     *
+     */
+    bool encoderChanged()
+    {
+      portENTER_CRITICAL( &state.mux );
+
+      bool changed = state.changed;
+      state.changed = false;
+
+      portEXIT_CRITICAL( &state.mux );
+
+      return changed;
+    }
+
+    /**
+     * @brief Get the current value.
+     *
+     */
+    long getEncoderValue()
+    {
+      return state.value;
+    }
+
+    /**
+     * @brief Override the current value, within the boundaries.
+     *
+     */
+    void setEncoderValue( long newValue )
+    {
+      portENTER_CRITICAL( &state.mux );
+      state.value = constrain( newValue, state.minValue, state.maxValue );
+      portEXIT_CRITICAL( &state.mux );
+    }
+
+    /**
+     * @brief Call the `onTurned()` callback if the value has changed.
+     *
+     * There is no loop timer; call this from your own `loop()`.
+     *
+     */
+    void loop()
+    {
+      if( callback && encoderChanged() )
+        callback( getEncoderValue() );
+    }
+
+  private:
+
+    static constexpr int PinMode = ( Type == FLOATING ) ? INPUT_PULLUP : INPUT;
+    static constexpr int8_t TripPoint = Steps - 1;
+
+  #if SOC_GPIO_PIN_COUNT > 32
+    static constexpr uint32_t RegisterA = ( PinA >= 32 ) ? GPIO_IN1_REG : GPIO_IN_REG;
+    static constexpr uint32_t RegisterB = ( PinB >= 32 ) ? GPIO_IN1_REG : GPIO_IN_REG;
+  #else
+    static constexpr uint32_t RegisterA = GPIO_IN_REG;
+    static constexpr uint32_t RegisterB = GPIO_IN_REG;
+  #endif
+    static constexpr uint32_t MaskA = 1UL << ( PinA % 32 );
+    static constexpr uint32_t MaskB = 1UL << ( PinB % 32 );
+
+    /**
+     * @brief `RotaryEncoder::encoderStates` packed two bits per transition, each
+     * entry being the rotation + 1, so it costs no memory and the ISR needs no table.
+     *
+     */
+    static constexpr uint32_t Transitions = 0x49941661UL;
+
+    typedef struct {
+      portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+      volatile long value = 0;
+      long minValue = -1;
+      long maxValue = 1;
+      long stepValue = 1;
+      uint8_t previousAB = 3;
+      int8_t position = 0;
+      volatile bool changed = false;
+    } State;
+
+    static State state;
+
+    TurnedCallback callback;
+
+    /**
+     * @brief The Arduino pin number of a GPIO, which is what `pinMode()` and
+     * `attachInterrupt()` expect; the reverse of `RotaryEncoder::gpioNumber()`.
+     *
+     */
+    static int8_t arduinoPin( uint8_t gpio )
+    {
+    #if defined( BOARD_HAS_PIN_REMAP )
+      return digitalPinFromGPIONumber( gpio );
+    #else
+      return gpio;
+    #endif
+    }
+
+    /**
+     * @brief Read A (bit 1) and B (bit 0), from a single register read when both
+     * pins are in the same bank.
+     *
+     */
+    static inline uint8_t ARDUINO_ISR_ATTR readPins()
+    {
+      if( RegisterA == RegisterB )
+      {
+        uint32_t gpioInput = REG_READ( RegisterA );
+
+        return ( ( gpioInput & MaskA ) ? 0x02 : 0 ) | ( ( gpioInput & MaskB ) ? 0x01 : 0 );
+      }
+
+      return ( ( REG_READ( RegisterA ) & MaskA ) ? 0x02 : 0 ) | ( ( REG_READ( RegisterB ) & MaskB ) ? 0x01 : 0 );
+    }
+
+    static void ARDUINO_ISR_ATTR _encoder_ISR()
+    {
+      portENTER_CRITICAL_ISR( &state.mux );
+
+      state.previousAB = ( state.previousAB << 2 ) | readPins();
+      state.position += (int8_t)( ( Transitions >> ( ( state.previousAB & 0x0f ) * 2 ) ) & 0x03 ) - 1;
+
+      if( state.position > TripPoint || state.position < -TripPoint )
+      {
+        // Unsigned offsets from the minimum, as the full range of long doesn't fit a signed difference
+        unsigned long span = (unsigned long)state.maxValue - (unsigned long)state.minValue;
+        unsigned long offset = (unsigned long)state.value - (unsigned long)state.minValue;
+        unsigned long step = ( state.stepValue < 0 ) ? 0UL - (unsigned long)state.stepValue : (unsigned long)state.stepValue;
+        bool up = ( state.position > 0 ) == ( state.stepValue >= 0 );
+
+        // Past the boundary if the step is more than the room left on that side
+        unsigned long room = up ? span - offset : offset;
+
+        if( step <= room )
+          offset = up ? offset + step : offset - step;
+
+        else if( Circular )
+        {
+          // Wrap around by however far the step went past the boundary; a range of 0 is
+          // the whole of long, which unsigned arithmetic wraps around by itself
+          unsigned long range = span + 1;
+          unsigned long beyond = step - room - 1;
+
+          if( range == 0 )
+            offset = up ? offset + step : offset - step;
+          else
+            offset = up ? beyond % range : span - beyond % range;
+        }
+        else
+          offset = up ? span : 0;
+
+        state.value = (long)( (unsigned long)state.minValue + offset );
+        state.changed = true;
+        state.position = 0;
+      }
+
+      portEXIT_CRITICAL_ISR( &state.mux );
+    }
+};
+
+template<uint8_t PinA, uint8_t PinB, uint8_t Steps, bool Circular, EncoderType Type>
+typename RotaryEncoderT<PinA, PinB, Steps, Circular, Type>::State RotaryEncoderT<PinA, PinB, Steps, Circular, Type>::state;
+
+#endif